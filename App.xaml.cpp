@@ -1,7 +1,10 @@
 #include "pch.h"
 #include "App.xaml.h"
 #include "MainWindow.xaml.h"
+#include "Engine/ExtractionWorker.h"
+#include "Utils/EventLog.h"
 #include "Utils/Logger.h"
+#include "Utils/Settings.h"
 
 using namespace winrt;
 using namespace Microsoft::UI::Xaml;
@@ -9,6 +12,36 @@ using namespace Microsoft::UI::Xaml;
 // To learn more about WinUI, the WinUI project structure,
 // and more about our project templates, see: http://aka.ms/winui-project-info.
 
+// Logging setup shared by the app and its extraction workers
+static void StartLogging()
+{
+    // Log lines are written by a background thread from here on
+    ZipSpark::Logger::GetInstance().EnableAsync();
+
+    // Applies the saved logging preference before anything is logged
+    ZipSpark::Settings::GetInstance().Load();
+
+    // Extraction events go to a binary log beside the text log (read with ZipSpark.EventDump).
+    // Each process writes its own file, named like its text log.
+    if (ZipSpark::Settings::GetInstance().enableLogging)
+    {
+        std::error_code ec;
+        std::filesystem::path eventDirectory = std::filesystem::temp_directory_path(ec) / L"ZipSpark" / L"Logs";
+        std::filesystem::create_directories(eventDirectory, ec);
+
+        auto time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::tm tm;
+        localtime_s(&tm, &time);
+        std::wstringstream eventFile;
+        eventFile << L"ZipSpark_" << std::put_time(&tm, L"%Y%m%d_%H%M%S") << L"_" << GetCurrentProcessId() << L".zsev";
+
+        if (!ZipSpark::EventLog::GetInstance().Open(eventDirectory / eventFile.str()))
+        {
+            LOG_WARNING(L"Could not create event log in " + eventDirectory.wstring());
+        }
+    }
+}
+
 namespace winrt::ZipSpark_New::implementation
 {
     /// <summary>
@@ -19,6 +52,8 @@ namespace winrt::ZipSpark_New::implementation
     {
         try
         {
+            StartLogging();
+
             LOG_INFO(L"=== ZipSpark Application Starting ===");
             LOG_INFO(L"App constructor called");
             
@@ -243,3 +278,38 @@ namespace winrt::ZipSpark_New::implementation
         }
     }
 }
+
+// Replaces the XAML-generated entry point (DISABLE_XAML_GENERATED_MAIN): the
+// same executable also runs as a headless extraction worker for WorkerPool,
+// which must not start the UI
+int __stdcall wWinMain(HINSTANCE, HINSTANCE, PWSTR, int)
+{
+    if (ZipSpark::ExtractionWorker::IsWorkerCommandLine(GetCommandLineW()))
+    {
+        StartLogging();
+        int exitCode = ZipSpark::ExtractionWorker::Run();
+        ZipSpark::EventLog::GetInstance().Close();
+        return exitCode;
+    }
+
+    void (WINAPI *pfnXamlCheckProcessRequirements)();
+    auto module = ::LoadLibrary(L"Microsoft.ui.xaml.dll");
+    if (module)
+    {
+        pfnXamlCheckProcessRequirements = reinterpret_cast<decltype(pfnXamlCheckProcessRequirements)>(GetProcAddress(module, "XamlCheckProcessRequirements"));
+        if (pfnXamlCheckProcessRequirements)
+        {
+            (*pfnXamlCheckProcessRequirements)();
+        }
+        ::FreeLibrary(module);
+    }
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+    ::winrt::Microsoft::UI::Xaml::Application::Start(
+        [](auto&&)
+        {
+            ::winrt::make<::winrt::ZipSpark_New::implementation::App>();
+        });
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "pch.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ZipSpark
+{
+    /// <summary>
+    /// One entry of an archive's table of contents.
+    /// Fixed-size and pointer-free so an index file can be used in place
+    /// straight from a memory mapping.
+    /// </summary>
+    struct ArchiveIndexEntry
+    {
+        enum Flags : uint16_t
+        {
+            Directory = 1 << 0,
+            Encrypted = 1 << 1,
+            Sparse = 1 << 2
+        };
+
+        static constexpr uint32_t NO_BLOCK = 0xFFFFFFFF;
+
+        uint64_t size = 0;            // Uncompressed size
+        uint64_t compressedSize = 0;  // 0 if the reader does not know it
+        int64_t headerOffset = -1;    // Position of the entry header in the archive, -1 if unknown
+        int64_t modifiedTime = 0;     // Unix time
+        uint32_t nameOffset = 0;      // UTF-8 path in the name pool
+        uint32_t nameLength = 0;
+        uint32_t crc = 0;             // 0 if unknown
+        uint32_t attributes = 0;      // Windows FILE_ATTRIBUTE_* bits, 0 if unknown
+        uint32_t block = NO_BLOCK;    // Solid block holding the data, NO_BLOCK if none or unknown
+        uint16_t method = 0;          // Format-specific compression method, 0 if unknown
+        uint16_t flags = 0;
+
+        bool IsDirectory() const { return (flags & Directory) != 0; }
+    };
+
+    /// <summary>
+    /// Entry table of an archive plus the totals derived from it.
+    /// Either built in memory while scanning headers, or viewed directly out of
+    /// a mapped index cache file (the mapping is kept alive by the index).
+    /// </summary>
+    class ArchiveIndex
+    {
+    public:
+        struct Summary
+        {
+            uint64_t totalSize = 0;
+            uint32_t fileCount = 0;
+            uint32_t directoryCount = 0;
+            bool isEncrypted = false;
+            bool hasSingleRoot = false;
+        };
+
+        ArchiveIndex() = default;
+
+        // View over external storage (e.g. a mapped cache file kept alive by owner)
+        ArchiveIndex(std::shared_ptr<const void> owner, const ArchiveIndexEntry* entries, size_t entryCount,
+                     const char* names, size_t namesSize, const Summary& summary)
+            : m_owner(std::move(owner))
+            , m_entries(entries)
+            , m_entryCount(entryCount)
+            , m_names(names)
+            , m_namesSize(namesSize)
+            , m_summary(summary)
+        {
+        }
+
+        /// <summary>
+        /// Append an entry while building; name is the UTF-8 archive path
+        /// </summary>
+        void AddEntry(std::string_view name, ArchiveIndexEntry entry)
+        {
+            entry.nameOffset = static_cast<uint32_t>(m_ownedNames.size());
+            entry.nameLength = static_cast<uint32_t>(name.size());
+            m_ownedNames.append(name.data(), name.size());
+            m_ownedEntries.push_back(entry);
+
+            m_entries = m_ownedEntries.data();
+            m_entryCount = m_ownedEntries.size();
+            m_names = m_ownedNames.data();
+            m_namesSize = m_ownedNames.size();
+        }
+
+        void Reserve(size_t entryCount)
+        {
+            m_ownedEntries.reserve(entryCount);
+        }
+
+        size_t GetEntryCount() const { return m_entryCount; }
+        const ArchiveIndexEntry* GetEntries() const { return m_entries; }
+        const ArchiveIndexEntry& GetEntry(size_t index) const { return m_entries[index]; }
+
+        std::string_view GetName(const ArchiveIndexEntry& entry) const
+        {
+            return std::string_view(m_names + entry.nameOffset, entry.nameLength);
+        }
+
+        const char* GetNamePool() const { return m_names; }
+        size_t GetNamePoolSize() const { return m_namesSize; }
+
+        const Summary& GetSummary() const { return m_summary; }
+        void SetSummary(const Summary& summary) { m_summary = summary; }
+
+    private:
+        ArchiveIndex(const ArchiveIndex&) = delete;
+        ArchiveIndex& operator=(const ArchiveIndex&) = delete;
+
+        // Storage while building
+        std::vector<ArchiveIndexEntry> m_ownedEntries;
+        std::string m_ownedNames;
+
+        // Storage when viewing a cache file
+        std::shared_ptr<const void> m_owner;
+
+        const ArchiveIndexEntry* m_entries = nullptr;
+        size_t m_entryCount = 0;
+        const char* m_names = nullptr;
+        size_t m_namesSize = 0;
+        Summary m_summary;
+    };
+}
@@ -1,7 +1,9 @@
 #pragma once
 #include "pch.h"
+#include "ArchiveIndex.h"
 #include <string>
 #include <cstdint>
+#include <memory>
 
 namespace ZipSpark
 {
@@ -41,6 +43,11 @@ namespace ZipSpark
         /// </summary>
         uint64_t totalSize = 0;
 
+        /// <summary>
+        /// Total compressed size of the entries in bytes (0 if unknown)
+        /// </summary>
+        uint64_t packedSize = 0;
+
         /// <summary>
         /// Number of files in the archive
         /// </summary>
@@ -56,6 +63,17 @@ namespace ZipSpark
         /// </summary>
         bool isEncrypted = false;
 
+        /// <summary>
+        /// Whether entries share solid blocks, so one can't be decoded
+        /// without the entries before it in its block
+        /// </summary>
+        bool isSolid = false;
+
+        /// <summary>
+        /// Number of solid blocks (0 if not solid or unknown)
+        /// </summary>
+        uint32_t solidBlockCount = 0;
+
         /// <summary>
         /// Destination path for extraction (context-aware)
         /// </summary>
@@ -67,6 +85,12 @@ namespace ZipSpark
         /// </summary>
         bool hasSingleRoot = false;
 
+        /// <summary>
+        /// Entry table from the header scan or the index cache
+        /// (null if the archive could not be scanned)
+        /// </summary>
+        std::shared_ptr<const ArchiveIndex> index;
+
         /// <summary>
         /// Get format as string for display
         /// </summary>
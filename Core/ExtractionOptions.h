@@ -1,10 +1,15 @@
 #pragma once
 #include "pch.h"
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <optional>
+#include <vector>
 
 namespace ZipSpark
 {
+    class MemoryFileTable;
+
     /// <summary>
     /// Policy for handling file conflicts during extraction
     /// </summary>
@@ -16,6 +21,16 @@ namespace ZipSpark
         Skip         // Skip conflicting files
     };
 
+    /// <summary>
+    /// How decoded data reaches the disk when decoding and writing are pipelined
+    /// </summary>
+    enum class WriteBackend
+    {
+        Auto,        // I/O ring where the system has one, writer threads otherwise
+        ThreadPool,  // Writer threads issuing one system call per operation
+        IoRing       // Batched submission through a Windows I/O ring
+    };
+
     /// <summary>
     /// Configuration options for archive extraction
     /// </summary>
@@ -26,6 +41,12 @@ namespace ZipSpark
         /// </summary>
         std::wstring destinationPath;
 
+        /// <summary>
+        /// Archive paths to extract; a folder selects its contents and
+        /// '*'/'?' globs are allowed. Empty extracts everything.
+        /// </summary>
+        std::vector<std::wstring> selection;
+
         /// <summary>
         /// Whether to create a subfolder for extraction
         /// </summary>
@@ -52,10 +73,66 @@ namespace ZipSpark
         uint32_t bufferSize = 65536; // 64 KB default
 
         /// <summary>
-        /// Whether to cache extracted data in memory for performance
+        /// Size of the aligned buffer that gathers decoded blocks into large
+        /// disk writes (bytes, 0 = write every block as it comes)
+        /// </summary>
+        uint32_t writeBufferSize = 1024 * 1024; // 1 MB default
+
+        /// <summary>
+        /// Entries at least this large are written unbuffered, bypassing the
+        /// system file cache (bytes, 0 = never)
+        /// </summary>
+        uint64_t unbufferedWriteThreshold = 512ull * 1024 * 1024; // 512 MB default
+
+        /// <summary>
+        /// Upper bound on decoded data waiting for the writer threads when
+        /// decoding and writing are pipelined (bytes)
+        /// </summary>
+        uint64_t pipelineMemoryLimit = 64ull * 1024 * 1024; // 64 MB default
+
+        /// <summary>
+        /// Write stage used when decoding and writing are pipelined
+        /// </summary>
+        WriteBackend writeBackend = WriteBackend::Auto;
+
+        /// <summary>
+        /// Largest archive that is memory-mapped for reading (bytes, 0 = never map).
+        /// Bigger archives are read through buffered I/O instead.
+        /// </summary>
+        uint64_t memoryMapLimit = sizeof(void*) >= 8 ? (256ull << 30) : (512ull << 20); // 256 GB on 64-bit, 512 MB on 32-bit
+
+        /// <summary>
+        /// Decode entries into memory instead of writing each one to disk as it
+        /// comes. With memoryTarget set the entries stay there for the caller;
+        /// otherwise they are written to the destination in large batches.
         /// </summary>
         bool cacheToMemory = false;
 
+        /// <summary>
+        /// Memory budget of the in-memory table when cacheToMemory is set (bytes).
+        /// When batching to disk, a full table is flushed and entries larger
+        /// than the budget are written directly.
+        /// </summary>
+        uint64_t memoryBudget = 256ull * 1024 * 1024; // 256 MB default
+
+        /// <summary>
+        /// Table receiving the entries when cacheToMemory is set; nothing is
+        /// written to disk. Entries that do not fit its budget fail the extraction.
+        /// </summary>
+        std::shared_ptr<MemoryFileTable> memoryTarget;
+
+        /// <summary>
+        /// Stop an extraction running in a helper process once it has made no
+        /// forward progress for this long (milliseconds, 0 = never)
+        /// </summary>
+        uint32_t stallTimeoutMs = 120000; // 2 minutes default
+
+        /// <summary>
+        /// Limit on the total run time of an extraction in a helper process,
+        /// however it is progressing (milliseconds, 0 = none)
+        /// </summary>
+        uint32_t deadlineMs = 0;
+
         /// <summary>
         /// Whether to preserve file timestamps
         /// </summary>
@@ -1,6 +1,8 @@
 #pragma once
 #include "pch.h"
+#include "ExtractionOptions.h"
 #include <string>
+#include <vector>
 #include <atomic>
 #include <chrono>
 
@@ -41,6 +43,16 @@ namespace ZipSpark
         /// Called when extraction fails
         /// </summary>
         virtual void OnError(ErrorCode errorCode, const std::wstring& errorMessage) = 0;
+
+        /// <summary>
+        /// Called once before extraction when the policy is Prompt and entries
+        /// would replace existing files (paths relative to the destination).
+        /// Returns the policy to apply to all of them.
+        /// </summary>
+        virtual OverwritePolicy ResolveConflicts(const std::vector<std::wstring>& /*conflicts*/)
+        {
+            return OverwritePolicy::AutoRename;
+        }
     };
 
     /// <summary>
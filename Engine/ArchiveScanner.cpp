@@ -0,0 +1,260 @@
+#include "pch.h"
+#include "ArchiveScanner.h"
+#include "ArchiveSource.h"
+#include "../Utils/ArchiveIndexCache.h"
+#include "../Utils/Logger.h"
+#include <chrono>
+#include <cstring>
+#include <archive.h>
+#include <archive_entry.h>
+
+namespace ZipSpark {
+
+// First path component of an archive entry, without "./" or leading separators.
+// Works on the raw pathname bytes: comparing roots needs no wide conversion.
+static void SplitRoot(const char* path, const char*& root, size_t& rootLength, bool& hasChildren)
+{
+    for (;;)
+    {
+        while (*path == '/' || *path == '\\')
+        {
+            path++;
+        }
+        if (path[0] == '.' && (path[1] == '/' || path[1] == '\\'))
+        {
+            path += 2;
+            continue;
+        }
+        break;
+    }
+
+    root = path;
+    rootLength = strcspn(path, "/\\");
+
+    // Anything after the separator makes the root a directory ("a/" alone does not count)
+    const char* rest = path + rootLength;
+    while (*rest == '/' || *rest == '\\')
+    {
+        rest++;
+    }
+    hasChildren = *rest != '\0';
+}
+
+// Whether archive_read_next_header reaches the next entry with a seek rather
+// than by decoding the current one. libarchive does not tell solid 7z and
+// RAR archives apart from non-solid ones, so neither counts.
+static bool CanSkipData(struct archive* a)
+{
+    int format = archive_format(a) & ARCHIVE_FORMAT_BASE_MASK;
+    if (format == ARCHIVE_FORMAT_ZIP)
+    {
+        return true;
+    }
+    return archive_filter_code(a, 0) == ARCHIVE_FILTER_NONE && format != ARCHIVE_FORMAT_7ZIP &&
+           format != ARCHIVE_FORMAT_RAR && format != ARCHIVE_FORMAT_RAR_V5;
+}
+
+bool ArchiveScanner::Scan(const std::wstring& archivePath, Mode mode, ArchiveInfo& info)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Unchanged since the last full scan: use the stored entry table
+    if (auto cached = ArchiveIndexCache::GetInstance().Lookup(archivePath))
+    {
+        const ArchiveIndex::Summary& summary = cached->GetSummary();
+        info.totalSize = summary.totalSize;
+        info.fileCount = summary.fileCount;
+        info.directoryCount = summary.directoryCount;
+        info.isEncrypted = summary.isEncrypted;
+        info.hasSingleRoot = summary.hasSingleRoot;
+        info.index = cached;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+        LOG_INFO(L"Index cache hit: " + std::to_wstring(cached->GetEntryCount()) + L" entries in " +
+                 std::to_wstring(elapsed) + L" ms");
+        return true;
+    }
+
+    // Random access: the reader jumps from header to header
+    auto source = ArchiveSource::Open(archivePath, ExtractionOptions(), ArchiveSource::Access::Random);
+
+    struct archive* a = archive_read_new();
+    if (!a)
+    {
+        return false;
+    }
+    archive_read_support_filter_all(a);
+    archive_read_support_format_all(a);
+
+    if (source->OpenReader(a) != ARCHIVE_OK)
+    {
+        LOG_WARNING(L"Header scan could not open archive: " + archivePath);
+        archive_read_free(a);
+        return false;
+    }
+
+    uint64_t totalSize = 0;
+    uint32_t fileCount = 0;
+    uint32_t directoryCount = 0;
+    bool encrypted = false;
+
+    std::string firstRoot;
+    bool sawRoot = false;
+    bool singleRoot = true;
+    bool rootIsDirectory = false;
+
+    // Entry table, only for full scans
+    std::shared_ptr<ArchiveIndex> index;
+    if (mode == Mode::Full)
+    {
+        index = std::make_shared<ArchiveIndex>();
+    }
+    bool decodes = false;
+
+    struct archive_entry* entry;
+    int result;
+    while ((result = archive_read_next_header(a, &entry)) == ARCHIVE_OK || result == ARCHIVE_WARN)
+    {
+        if (archive_entry_filetype(entry) == AE_IFDIR)
+        {
+            directoryCount++;
+        }
+        else
+        {
+            fileCount++;
+            if (archive_entry_size_is_set(entry))
+            {
+                totalSize += static_cast<uint64_t>(archive_entry_size(entry));
+            }
+        }
+
+        if (archive_entry_is_encrypted(entry))
+        {
+            encrypted = true;
+        }
+
+        if (index)
+        {
+            ArchiveIndexEntry indexEntry;
+            indexEntry.size = archive_entry_size_is_set(entry) ? static_cast<uint64_t>(archive_entry_size(entry)) : 0;
+            indexEntry.headerOffset = archive_read_header_position(a);
+            indexEntry.modifiedTime = archive_entry_mtime_is_set(entry) ? static_cast<int64_t>(archive_entry_mtime(entry)) : 0;
+            indexEntry.flags = static_cast<uint16_t>(
+                (archive_entry_filetype(entry) == AE_IFDIR ? ArchiveIndexEntry::Directory : 0) |
+                (archive_entry_is_encrypted(entry) ? ArchiveIndexEntry::Encrypted : 0) |
+                (archive_entry_sparse_count(entry) > 0 ? ArchiveIndexEntry::Sparse : 0));
+            // libarchive does not expose compressed sizes, methods or CRCs; they stay 0
+
+            const char* name = archive_entry_pathname_utf8(entry);
+            if (!name)
+            {
+                name = archive_entry_pathname(entry);
+            }
+            index->AddEntry(name ? std::string_view(name) : std::string_view(), indexEntry);
+        }
+
+        if (const char* path = archive_entry_pathname(entry))
+        {
+            const char* root;
+            size_t rootLength;
+            bool hasChildren;
+            SplitRoot(path, root, rootLength, hasChildren);
+
+            if (rootLength > 0)
+            {
+                if (!sawRoot)
+                {
+                    firstRoot.assign(root, rootLength);
+                    sawRoot = true;
+                }
+                else if (singleRoot && (firstRoot.size() != rootLength || memcmp(firstRoot.data(), root, rootLength) != 0))
+                {
+                    singleRoot = false;
+                    if (mode == Mode::Quick)
+                    {
+                        break;
+                    }
+                }
+
+                if (hasChildren || archive_entry_filetype(entry) == AE_IFDIR)
+                {
+                    rootIsDirectory = true;
+                }
+            }
+        }
+
+        // Headers only. Format and filters are known once the first header
+        // is read; stop there if skipping the data would mean decoding it.
+        // The layout usually shows within the first few entries, so a quick
+        // scan decodes on, up to its limit.
+        if (!CanSkipData(a) &&
+            (mode == Mode::Full || static_cast<uint64_t>(archive_filter_bytes(a, -1)) > QUICK_READ_LIMIT))
+        {
+            decodes = true;
+            break;
+        }
+        archive_read_data_skip(a);
+    }
+
+    // Header-encrypted archives (7z -mhe) fail on the first header
+    if (archive_read_has_encrypted_entries(a) > 0)
+    {
+        encrypted = true;
+    }
+
+    // Two roots settle a quick scan; so does the end of the archive
+    if (mode == Mode::Quick && (!singleRoot || (!decodes && result == ARCHIVE_EOF)))
+    {
+        archive_read_free(a);
+        info.isEncrypted = info.isEncrypted || encrypted;
+        info.hasSingleRoot = sawRoot && singleRoot && rootIsDirectory;
+        LOG_INFO(L"Quick header scan: " + std::wstring(info.hasSingleRoot ? L"single root" : L"several roots") +
+                 L" after " + std::to_wstring(fileCount + directoryCount) + L" entries");
+        return true;
+    }
+
+    if (decodes)
+    {
+        LOG_INFO(mode == Mode::Quick ? L"Quick header scan stopped at its read limit" :
+                                       L"Header scan stopped: listing this archive would decompress it");
+    }
+    else if (result != ARCHIVE_EOF)
+    {
+        const char* error = archive_error_string(a);
+        std::string what = error ? error : "unknown error";
+        LOG_WARNING(L"Header scan stopped after " + std::to_wstring(fileCount + directoryCount) + L" entries: " +
+                    std::wstring(what.begin(), what.end()));
+    }
+    archive_read_free(a);
+
+    // Partial counts would pass for the whole archive
+    info.isEncrypted = info.isEncrypted || encrypted;
+    if (mode == Mode::Quick || decodes || result != ARCHIVE_EOF)
+    {
+        return false;
+    }
+
+    info.totalSize = totalSize;
+    info.fileCount = fileCount;
+    info.directoryCount = directoryCount;
+    info.hasSingleRoot = sawRoot && singleRoot && rootIsDirectory;
+
+    ArchiveIndex::Summary summary;
+    summary.totalSize = info.totalSize;
+    summary.fileCount = info.fileCount;
+    summary.directoryCount = info.directoryCount;
+    summary.isEncrypted = info.isEncrypted;
+    summary.hasSingleRoot = info.hasSingleRoot;
+    index->SetSummary(summary);
+
+    ArchiveIndexCache::GetInstance().Store(archivePath, *index);
+    info.index = index;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    LOG_INFO(L"Header scan: " + std::to_wstring(fileCount) + L" files, " + std::to_wstring(directoryCount) +
+             L" directories, " + std::to_wstring(totalSize) + L" bytes in " + std::to_wstring(elapsed) + L" ms" +
+             (info.hasSingleRoot ? L" (single root)" : L""));
+    return true;
+}
+
+} // namespace ZipSpark
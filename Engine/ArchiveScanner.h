@@ -0,0 +1,39 @@
+#pragma once
+#include "../Core/ArchiveInfo.h"
+#include <string>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Header-only archive scan shared by the extraction engines.
+/// Walks the entry headers with libarchive, seeking over the data; for ZIP
+/// the seekable reader takes the headers from the central directory. Fills
+/// the uncompressed total, file/directory counts, the encryption flag and
+/// whether everything sits under one root folder, builds the entry table and
+/// goes through the persistent index cache.
+/// Where reaching the next header means decoding the data (compressed
+/// tarballs, 7z and RAR, which may be solid) a full scan stops after the
+/// first header instead: that would decompress the archive once more before
+/// extraction does. A quick scan only settles the root layout (the
+/// createSubfolder decision) and stops at the second distinct root.
+/// </summary>
+class ArchiveScanner
+{
+public:
+    enum class Mode
+    {
+        Full,  // Every header: totals, counts and info.index are exact
+        Quick  // Only hasSingleRoot: stops at the second distinct root, decoding
+               // at most QUICK_READ_LIMIT bytes where skipping means decoding
+    };
+
+    static constexpr uint64_t QUICK_READ_LIMIT = 4 * 1024 * 1024;
+
+    // Full: returns false unless every header was read without decoding any
+    // data (layout as above, unreadable or damaged archive).
+    // Quick: returns false if the layout was not settled within the limit.
+    // On false, info is left as it was apart from isEncrypted.
+    static bool Scan(const std::wstring& archivePath, Mode mode, ArchiveInfo& info);
+};
+
+} // namespace ZipSpark
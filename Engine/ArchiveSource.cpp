@@ -0,0 +1,215 @@
+#include "pch.h"
+#include "ArchiveSource.h"
+#include "../Utils/Logger.h"
+#include <cstdio>
+#include <archive.h>
+
+namespace ZipSpark {
+
+// Bytes handed to libarchive per read callback
+constexpr size_t VIEW_CHUNK_SIZE = 1024 * 1024; // 1 MB
+
+// How far ahead of the reader we ask the memory manager to page in
+constexpr uint64_t PREFETCH_WINDOW = 32ull * 1024 * 1024; // 32 MB
+
+// Block size for buffered (unmapped) reads; libarchive's default of 10 KB
+// turns a multi-GB archive into hundreds of thousands of read() calls
+constexpr size_t BUFFERED_BLOCK_SIZE = 1024 * 1024; // 1 MB
+
+// Reader cursor into the mapped view; one per libarchive reader
+struct ViewCursor
+{
+    const uint8_t* view;
+    uint64_t size;
+    uint64_t position;
+    uint64_t prefetchedUntil;
+};
+
+static void PrefetchAhead(ViewCursor& cursor)
+{
+    // Refill the window once the reader is halfway through it
+    if (cursor.prefetchedUntil >= cursor.size ||
+        cursor.position + PREFETCH_WINDOW / 2 < cursor.prefetchedUntil)
+    {
+        return;
+    }
+
+    uint64_t start = std::max(cursor.position, cursor.prefetchedUntil);
+    uint64_t end = std::min(cursor.size, cursor.position + PREFETCH_WINDOW);
+    if (end <= start)
+    {
+        return;
+    }
+
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<uint8_t*>(cursor.view + start);
+    range.NumberOfBytes = static_cast<SIZE_T>(end - start);
+
+    // Best effort: a failed hint only costs us the read-ahead
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    cursor.prefetchedUntil = end;
+}
+
+static la_ssize_t ViewRead(struct archive*, void* clientData, const void** buffer)
+{
+    auto* cursor = static_cast<ViewCursor*>(clientData);
+    if (cursor->position >= cursor->size)
+    {
+        *buffer = nullptr;
+        return 0;
+    }
+
+    PrefetchAhead(*cursor);
+
+    // Zero-copy: libarchive reads straight out of the mapped view
+    uint64_t chunk = std::min<uint64_t>(VIEW_CHUNK_SIZE, cursor->size - cursor->position);
+    *buffer = cursor->view + cursor->position;
+    cursor->position += chunk;
+    return static_cast<la_ssize_t>(chunk);
+}
+
+static la_int64_t ViewSkip(struct archive*, void* clientData, la_int64_t request)
+{
+    auto* cursor = static_cast<ViewCursor*>(clientData);
+    uint64_t skipped = std::min<uint64_t>(static_cast<uint64_t>(request), cursor->size - cursor->position);
+    cursor->position += skipped;
+    return static_cast<la_int64_t>(skipped);
+}
+
+static la_int64_t ViewSeek(struct archive*, void* clientData, la_int64_t offset, int whence)
+{
+    auto* cursor = static_cast<ViewCursor*>(clientData);
+
+    int64_t base = 0;
+    switch (whence)
+    {
+    case SEEK_SET: base = 0; break;
+    case SEEK_CUR: base = static_cast<int64_t>(cursor->position); break;
+    case SEEK_END: base = static_cast<int64_t>(cursor->size); break;
+    default: return ARCHIVE_FATAL;
+    }
+
+    int64_t target = base + offset;
+    if (target < 0)
+    {
+        return ARCHIVE_FATAL;
+    }
+
+    cursor->position = std::min(static_cast<uint64_t>(target), cursor->size);
+    return static_cast<la_int64_t>(cursor->position);
+}
+
+static int ViewClose(struct archive*, void* clientData)
+{
+    delete static_cast<ViewCursor*>(clientData);
+    return ARCHIVE_OK;
+}
+
+ArchiveSource::~ArchiveSource()
+{
+    if (m_view)
+    {
+        UnmapViewOfFile(m_view);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+    }
+    if (m_file)
+    {
+        CloseHandle(static_cast<HANDLE>(m_file));
+    }
+}
+
+std::shared_ptr<ArchiveSource> ArchiveSource::Open(const std::wstring& archivePath, const ExtractionOptions& options,
+                                                   Access access)
+{
+    std::shared_ptr<ArchiveSource> source(new ArchiveSource());
+    source->m_path = archivePath;
+    source->m_access = access;
+    source->m_blockSize = std::max<size_t>(options.bufferSize, BUFFERED_BLOCK_SIZE);
+
+    if (options.memoryMapLimit > 0 && source->Map(options.memoryMapLimit))
+    {
+        LOG_INFO(L"Memory-mapped archive input (" + std::to_wstring(source->m_size) + L" bytes)");
+    }
+    else
+    {
+        LOG_INFO(L"Buffered archive input (" + std::to_wstring(source->m_blockSize) + L" byte blocks)");
+    }
+
+    return source;
+}
+
+bool ArchiveSource::Map(uint64_t mapLimit)
+{
+    DWORD accessHint = m_access == Access::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    HANDLE file = CreateFileW(m_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, accessHint, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    m_file = file;
+
+    // Pipes and character devices can't be mapped
+    if (GetFileType(file) != FILE_TYPE_DISK)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+    {
+        return false;
+    }
+
+    uint64_t size = static_cast<uint64_t>(fileSize.QuadPart);
+    if (size > mapLimit || size > static_cast<uint64_t>(SIZE_MAX))
+    {
+        LOG_INFO(L"Archive exceeds memory-map budget, using buffered reads");
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        return false;
+    }
+    m_mapping = mapping;
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        LOG_WARNING(L"MapViewOfFile failed (" + std::to_wstring(GetLastError()) + L"), using buffered reads");
+        return false;
+    }
+
+    m_view = static_cast<const uint8_t*>(view);
+    m_size = size;
+    return true;
+}
+
+int ArchiveSource::OpenReader(struct archive* a) const
+{
+    if (!m_view)
+    {
+        // Use native wide-char API for Windows
+        return archive_read_open_filename_w(a, m_path.c_str(), m_blockSize);
+    }
+
+    // Random access starts "fully prefetched" so no read-ahead is issued
+    uint64_t prefetchedUntil = m_access == Access::Sequential ? 0 : m_size;
+    auto* cursor = new ViewCursor{ m_view, m_size, 0, prefetchedUntil };
+
+    archive_read_set_read_callback(a, ViewRead);
+    archive_read_set_skip_callback(a, ViewSkip);
+    archive_read_set_seek_callback(a, ViewSeek);
+    archive_read_set_close_callback(a, ViewClose);
+    archive_read_set_callback_data(a, cursor);
+
+    // libarchive invokes the close callback (and frees the cursor) on failure too
+    return archive_read_open1(a);
+}
+
+} // namespace ZipSpark
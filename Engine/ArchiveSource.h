@@ -0,0 +1,58 @@
+#pragma once
+#include "../Core/ExtractionOptions.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct archive;
+
+namespace ZipSpark {
+
+/// <summary>
+/// Input side of an extraction.
+/// Maps the whole archive read-only and feeds it to libarchive through the
+/// callback open path, so every reader (including parallel workers) shares one
+/// view of the file. Pipes, empty files and files above the address-space
+/// budget fall back to buffered reads.
+/// </summary>
+class ArchiveSource
+{
+public:
+    // How readers will walk the archive
+    enum class Access
+    {
+        Sequential, // Extraction: read-ahead over the whole file
+        Random      // Header scans: seeks from header to header, no read-ahead
+    };
+
+    ~ArchiveSource();
+
+    static std::shared_ptr<ArchiveSource> Open(const std::wstring& archivePath, const ExtractionOptions& options,
+                                               Access access = Access::Sequential);
+
+    // Attach a new libarchive reader to this source (formats/filters must already be enabled).
+    // The source must outlive the reader.
+    int OpenReader(struct archive* a) const;
+
+    bool IsMapped() const { return m_view != nullptr; }
+    uint64_t GetSize() const { return m_size; }
+    const std::wstring& GetPath() const { return m_path; }
+
+private:
+    ArchiveSource() = default;
+    ArchiveSource(const ArchiveSource&) = delete;
+    ArchiveSource& operator=(const ArchiveSource&) = delete;
+
+    bool Map(uint64_t mapLimit);
+
+    std::wstring m_path;
+    size_t m_blockSize = 0;
+    Access m_access = Access::Sequential;
+
+    void* m_file = nullptr;     // HANDLE
+    void* m_mapping = nullptr;  // HANDLE
+    const uint8_t* m_view = nullptr;
+    uint64_t m_size = 0;
+};
+
+} // namespace ZipSpark
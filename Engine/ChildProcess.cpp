@@ -0,0 +1,273 @@
+#include "ChildProcess.h"
+#include <atomic>
+#include <windows.h>
+
+namespace ZipSpark {
+
+ChildProcess::~ChildProcess()
+{
+    if (m_started && !m_exited)
+    {
+        Terminate();
+        Wait();
+    }
+    CloseHandles();
+}
+
+// Quote one argument so CommandLineToArgvW (and the MSVC runtime) parse it back unchanged
+static void AppendQuotedArgument(std::wstring& commandLine, const std::wstring& argument)
+{
+    if (!commandLine.empty())
+    {
+        commandLine += L' ';
+    }
+
+    if (!argument.empty() && argument.find_first_of(L" \t\n\v\"") == std::wstring::npos)
+    {
+        commandLine += argument;
+        return;
+    }
+
+    commandLine += L'"';
+    for (size_t i = 0;; i++)
+    {
+        size_t backslashes = 0;
+        while (i < argument.size() && argument[i] == L'\\')
+        {
+            i++;
+            backslashes++;
+        }
+
+        if (i == argument.size())
+        {
+            // Backslashes before the closing quote are doubled
+            commandLine.append(backslashes * 2, L'\\');
+            break;
+        }
+        if (argument[i] == L'"')
+        {
+            commandLine.append(backslashes * 2 + 1, L'\\');
+        }
+        else
+        {
+            commandLine.append(backslashes, L'\\');
+        }
+        commandLine += argument[i];
+    }
+    commandLine += L'"';
+}
+
+bool ChildProcess::Start(const std::wstring& program, const std::vector<std::wstring>& arguments, std::wstring& error,
+                         bool pipeInput)
+{
+    // Anonymous pipes can't be read with a timeout; a uniquely named pipe
+    // opened for overlapped I/O on our end can
+    static std::atomic<uint32_t> pipeCounter{ 0 };
+    std::wstring pipeName = L"\\\\.\\pipe\\ZipSpark." + std::to_wstring(GetCurrentProcessId()) + L"." +
+                            std::to_wstring(pipeCounter.fetch_add(1));
+
+    HANDLE readEnd = CreateNamedPipeW(pipeName.c_str(), PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                                      PIPE_TYPE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 0, 64 * 1024, 0, nullptr);
+    if (readEnd == INVALID_HANDLE_VALUE)
+    {
+        error = L"Failed to create output pipe (error " + std::to_wstring(GetLastError()) + L")";
+        return false;
+    }
+
+    SECURITY_ATTRIBUTES inheritable = { sizeof(inheritable), nullptr, TRUE };
+    HANDLE writeEnd = CreateFileW(pipeName.c_str(), GENERIC_WRITE, 0, &inheritable, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    // Stdin: a pipe whose write end stays with us, or NUL
+    HANDLE input = INVALID_HANDLE_VALUE;
+    HANDLE inputWriter = nullptr;
+    if (pipeInput)
+    {
+        if (!CreatePipe(&input, &inputWriter, &inheritable, 0))
+        {
+            input = INVALID_HANDLE_VALUE;
+            inputWriter = nullptr;
+        }
+        else
+        {
+            SetHandleInformation(inputWriter, HANDLE_FLAG_INHERIT, 0);
+        }
+    }
+    else
+    {
+        input = CreateFileW(L"NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, &inheritable, OPEN_EXISTING, 0, nullptr);
+    }
+
+    if (writeEnd == INVALID_HANDLE_VALUE || input == INVALID_HANDLE_VALUE)
+    {
+        error = L"Failed to open child handles (error " + std::to_wstring(GetLastError()) + L")";
+        if (writeEnd != INVALID_HANDLE_VALUE) CloseHandle(writeEnd);
+        if (input != INVALID_HANDLE_VALUE) CloseHandle(input);
+        if (inputWriter) CloseHandle(inputWriter);
+        CloseHandle(readEnd);
+        return false;
+    }
+
+    // Only these two handles are inherited: a process started concurrently
+    // elsewhere must not hold our pipe open and delay end of output
+    HANDLE inherited[] = { writeEnd, input };
+    SIZE_T attributeSize = 0;
+    InitializeProcThreadAttributeList(nullptr, 1, 0, &attributeSize);
+    std::vector<char> attributeStorage(attributeSize);
+    auto attributes = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributeStorage.data());
+    bool haveAttributes = InitializeProcThreadAttributeList(attributes, 1, 0, &attributeSize) &&
+                          UpdateProcThreadAttribute(attributes, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, inherited,
+                                                    sizeof(inherited), nullptr, nullptr);
+
+    STARTUPINFOEXW startup = {};
+    startup.StartupInfo.cb = sizeof(startup);
+    startup.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+    startup.StartupInfo.hStdInput = input;
+    startup.StartupInfo.hStdOutput = writeEnd;
+    startup.StartupInfo.hStdError = writeEnd;
+    startup.lpAttributeList = haveAttributes ? attributes : nullptr;
+
+    std::wstring commandLine;
+    AppendQuotedArgument(commandLine, program);
+    for (const std::wstring& argument : arguments)
+    {
+        AppendQuotedArgument(commandLine, argument);
+    }
+
+    PROCESS_INFORMATION info = {};
+    DWORD flags = CREATE_NO_WINDOW | (haveAttributes ? EXTENDED_STARTUPINFO_PRESENT : 0);
+    BOOL created = CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, TRUE, flags, nullptr, nullptr,
+                                  &startup.StartupInfo, &info);
+    DWORD createError = GetLastError();
+
+    if (haveAttributes)
+    {
+        DeleteProcThreadAttributeList(attributes);
+    }
+
+    // The child has its copies; ours would keep the pipe open after it exits
+    CloseHandle(writeEnd);
+    CloseHandle(input);
+
+    if (!created)
+    {
+        CloseHandle(readEnd);
+        if (inputWriter) CloseHandle(inputWriter);
+        error = L"Failed to start " + program + L" (error " + std::to_wstring(createError) + L")";
+        return false;
+    }
+
+    CloseHandle(info.hThread);
+    m_process = info.hProcess;
+    m_output = readEnd;
+    m_input = inputWriter;
+    m_readEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    m_started = true;
+    return true;
+}
+
+ChildProcess::ReadResult ChildProcess::Read(char* buffer, size_t size, uint32_t timeoutMs, size_t& bytesRead)
+{
+    bytesRead = 0;
+    if (!m_output || !m_readEvent)
+    {
+        return ReadResult::End;
+    }
+
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = m_readEvent;
+    ResetEvent(m_readEvent);
+
+    DWORD toRead = static_cast<DWORD>(size < MAXDWORD ? size : MAXDWORD);
+    if (!ReadFile(m_output, buffer, toRead, nullptr, &overlapped))
+    {
+        if (GetLastError() != ERROR_IO_PENDING)
+        {
+            return ReadResult::End; // ERROR_BROKEN_PIPE: all writers are gone
+        }
+        if (WaitForSingleObject(m_readEvent, timeoutMs) == WAIT_TIMEOUT)
+        {
+            // Data arriving during the cancel still completes the read
+            CancelIoEx(m_output, &overlapped);
+        }
+    }
+
+    DWORD transferred = 0;
+    if (!GetOverlappedResult(m_output, &overlapped, &transferred, TRUE))
+    {
+        return GetLastError() == ERROR_OPERATION_ABORTED ? ReadResult::Timeout : ReadResult::End;
+    }
+    if (transferred == 0)
+    {
+        return ReadResult::Timeout;
+    }
+
+    bytesRead = transferred;
+    return ReadResult::Data;
+}
+
+bool ChildProcess::WriteInput(const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0 && m_input)
+    {
+        DWORD written = 0;
+        if (!WriteFile(m_input, bytes, static_cast<DWORD>(size < MAXDWORD ? size : MAXDWORD), &written, nullptr))
+        {
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return size == 0;
+}
+
+void ChildProcess::CloseInput()
+{
+    if (m_input)
+    {
+        CloseHandle(m_input);
+        m_input = nullptr;
+    }
+}
+
+void ChildProcess::Terminate()
+{
+    if (m_process && !m_exited)
+    {
+        TerminateProcess(m_process, 1);
+    }
+}
+
+int ChildProcess::Wait()
+{
+    if (m_process && !m_exited)
+    {
+        WaitForSingleObject(m_process, INFINITE);
+        DWORD exitCode = 0;
+        m_exitCode = GetExitCodeProcess(m_process, &exitCode) ? static_cast<int>(exitCode) : -1;
+        m_exited = true;
+    }
+    return m_exitCode;
+}
+
+void ChildProcess::CloseHandles()
+{
+    CloseInput();
+    if (m_output)
+    {
+        CloseHandle(m_output);
+        m_output = nullptr;
+    }
+    if (m_readEvent)
+    {
+        CloseHandle(m_readEvent);
+        m_readEvent = nullptr;
+    }
+    if (m_process)
+    {
+        CloseHandle(m_process);
+        m_process = nullptr;
+    }
+}
+
+} // namespace ZipSpark
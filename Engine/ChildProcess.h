@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Helper process with its stdout and stderr merged into one pipe the parent
+/// reads. Stdin is either a pipe the parent writes (long-lived workers taking
+/// requests) or the null device, so a tool waiting for input sees end of file
+/// instead of hanging. Reads take a timeout, letting the caller poll for
+/// cancellation while the child is silent. Terminates a still-running child
+/// on destruction.
+/// </summary>
+class ChildProcess
+{
+public:
+    enum class ReadResult
+    {
+        Data,     // bytesRead > 0
+        Timeout,  // Nothing arrived in time
+        End       // Pipe closed: the child exited (or closed its output)
+    };
+
+    ChildProcess() = default;
+    ~ChildProcess();
+
+    // Start program with the given arguments (not including the program name).
+    // pipeInput connects the child's stdin to WriteInput.
+    // Returns false with a description in error if it could not be launched.
+    bool Start(const std::wstring& program, const std::vector<std::wstring>& arguments, std::wstring& error,
+               bool pipeInput = false);
+
+    // Write all of data to the child's stdin; false if it is gone
+    bool WriteInput(const void* data, size_t size);
+
+    // Close the child's stdin so it sees end of input
+    void CloseInput();
+
+    // Wait up to timeoutMs for output
+    ReadResult Read(char* buffer, size_t size, uint32_t timeoutMs, size_t& bytesRead);
+
+    // Kill the child; safe to call after it exited
+    void Terminate();
+
+    // Wait for exit and return the exit code (-1 if unknown or killed by a signal)
+    int Wait();
+
+    bool IsStarted() const { return m_started; }
+
+private:
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+
+    void CloseHandles();
+
+    bool m_started = false;
+    bool m_exited = false;
+    int m_exitCode = -1;
+
+    void* m_process = nullptr;    // HANDLE
+    void* m_output = nullptr;     // Read end of the pipe (overlapped)
+    void* m_readEvent = nullptr;  // Completion event for reads on m_output
+    void* m_input = nullptr;      // Write end of the child's stdin pipe
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,125 @@
+#include "CompressionProfile.h"
+#include <algorithm>
+#include <cwctype>
+#include <thread>
+#include <windows.h>
+
+namespace ZipSpark {
+
+constexpr uint64_t MB = 1024 * 1024;
+
+// Smallest dictionary the memory limit may shrink to
+constexpr uint64_t MIN_DICTIONARY = 1 * MB;
+
+// A solid block spans this many dictionaries: large enough not to cost
+// ratio, small enough that one file doesn't mean decoding gigabytes, and
+// separate blocks can be extracted in parallel
+constexpr uint64_t SOLID_BLOCK_DICTIONARIES = 64;
+
+// LZMA2 encoder memory: about 11.5 times the dictionary (bt4 match finder),
+// one encoder per two threads
+static uint64_t EncoderMemory(uint64_t dictionarySize, uint32_t threadCount)
+{
+    uint64_t encoders = (threadCount + 1) / 2;
+    return encoders * (dictionarySize / 2 * 23);
+}
+
+CompressionProfile CompressionProfile::Create(CompressionLevel level, const std::wstring& format, uint32_t cores,
+                                              uint64_t availableMemory)
+{
+    std::wstring extension = format;
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::towlower);
+    bool is7z = extension == L".7z";
+    bool usesLzma2 = is7z || extension == L".xz";
+
+    CompressionProfile profile;
+    uint64_t dictionarySize = 0;
+    uint32_t threadCount = std::max<uint32_t>(1, cores);
+    uint64_t memoryBudget = availableMemory / 2;
+
+    switch (level)
+    {
+    case CompressionLevel::Store:
+        profile.level = 0;
+        return profile; // Copying needs neither threads nor a dictionary
+    case CompressionLevel::Fast:
+        profile.level = 1;
+        dictionarySize = 4 * MB;
+        break;
+    case CompressionLevel::Best:
+        profile.level = 9;
+        dictionarySize = 64 * MB;
+        if (memoryBudget == 0 || EncoderMemory(256 * MB, threadCount) <= memoryBudget)
+        {
+            dictionarySize = 256 * MB;
+        }
+        break;
+    default:
+        profile.level = 5;
+        dictionarySize = 16 * MB;
+        break;
+    }
+
+    if (!usesLzma2)
+    {
+        // ZIP's Deflate has a fixed window; 7-Zip compresses its files in parallel
+        profile.threadCount = threadCount;
+        return profile;
+    }
+
+    // Fit the encoders in the budget: smaller dictionary first, then fewer threads
+    if (memoryBudget != 0)
+    {
+        while (dictionarySize > MIN_DICTIONARY && EncoderMemory(dictionarySize, threadCount) > memoryBudget)
+        {
+            dictionarySize /= 2;
+        }
+        while (threadCount > 1 && EncoderMemory(dictionarySize, threadCount) > memoryBudget)
+        {
+            threadCount--;
+        }
+    }
+
+    profile.threadCount = threadCount;
+    profile.dictionarySize = dictionarySize;
+    if (is7z)
+    {
+        profile.solidBlockSize = dictionarySize * SOLID_BLOCK_DICTIONARIES;
+    }
+    return profile;
+}
+
+CompressionProfile CompressionProfile::ForThisMachine(CompressionLevel level, const std::wstring& format)
+{
+    uint32_t cores = std::thread::hardware_concurrency();
+
+    uint64_t availableMemory = 0;
+    MEMORYSTATUSEX status = {};
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status))
+    {
+        availableMemory = status.ullAvailPhys;
+    }
+
+    return Create(level, format, cores, availableMemory);
+}
+
+std::vector<std::wstring> CompressionProfile::ToArguments() const
+{
+    std::vector<std::wstring> arguments = { L"-mx=" + std::to_wstring(level) };
+    if (threadCount > 0)
+    {
+        arguments.push_back(L"-mmt=" + std::to_wstring(threadCount));
+    }
+    if (dictionarySize > 0)
+    {
+        arguments.push_back(L"-md=" + std::to_wstring(dictionarySize / MB) + L"m");
+    }
+    if (solidBlockSize > 0)
+    {
+        arguments.push_back(L"-ms=" + std::to_wstring(solidBlockSize / MB) + L"m");
+    }
+    return arguments;
+}
+
+} // namespace ZipSpark
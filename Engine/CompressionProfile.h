@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Positions of the compression slider in the create-archive dialog
+/// </summary>
+enum class CompressionLevel
+{
+    Store = 0,
+    Fast = 1,
+    Normal = 2,
+    Best = 3
+};
+
+/// <summary>
+/// 7-Zip method settings for creating an archive: level, thread count,
+/// dictionary size and solid block size. Derived from the slider position
+/// and the machine: every core is used, and the dictionary shrinks (then the
+/// thread count drops) until the encoders fit in half the available memory.
+/// Portable (no Win32 dependency outside ForThisMachine).
+/// </summary>
+struct CompressionProfile
+{
+    int level = 5;                // -mx, 0 (store) to 9
+    uint32_t threadCount = 0;     // -mmt, 0 = 7-Zip decides
+    uint64_t dictionarySize = 0;  // -md in bytes, 0 = method default
+    uint64_t solidBlockSize = 0;  // -ms in bytes, 0 = format default (7z only)
+
+    // Profile for a format (".7z", ".zip", ...) on a machine with this many
+    // cores and this much memory available
+    static CompressionProfile Create(CompressionLevel level, const std::wstring& format, uint32_t cores,
+                                     uint64_t availableMemory);
+
+    // Create, with this machine's core count and available memory
+    static CompressionProfile ForThisMachine(CompressionLevel level, const std::wstring& format);
+
+    // 7z switches ("-mx=9", "-mmt=8", ...) for the fields that are set
+    std::vector<std::wstring> ToArguments() const;
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,177 @@
+#include "pch.h"
+#include "DestinationSnapshot.h"
+#include "EntrySelector.h"
+#include "../Core/ArchiveIndex.h"
+#include "../Core/ArchiveInfo.h"
+#include "../Core/ExtractionProgress.h"
+#include "../Utils/Logger.h"
+#include "../Utils/PathValidator.h"
+#include "../Utils/Utf8.h"
+#include <cwctype>
+
+namespace ZipSpark {
+
+DestinationSnapshot::DestinationSnapshot(const std::wstring& root)
+    : m_root(root)
+{
+    while (!m_root.empty() && (m_root.back() == L'\\' || m_root.back() == L'/'))
+    {
+        m_root.pop_back();
+    }
+}
+
+void DestinationSnapshot::ListDirectory(const std::wstring& directoryKey) const
+{
+    if (!m_listed.insert(directoryKey).second)
+    {
+        return;
+    }
+
+    // A directory that does not exist (yet) lists as empty
+    std::wstring pattern = m_root + L"\\" + (directoryKey.empty() ? std::wstring() : directoryKey + L"\\") + L"*";
+    WIN32_FIND_DATAW data;
+    HANDLE find = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr,
+                                   FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    size_t count = 0;
+    do
+    {
+        std::wstring_view name(data.cFileName);
+        if (name == L"." || name == L"..")
+        {
+            continue;
+        }
+
+        // A link counts as what an entry would collide with; it is not followed
+        std::wstring relativePath = directoryKey.empty() ? std::wstring(name) : directoryKey + L"\\" + std::wstring(name);
+        m_paths.insert(MakeKey(relativePath));
+        count++;
+    } while (FindNextFileW(find, &data));
+
+    FindClose(find);
+    if (directoryKey.empty())
+    {
+        m_rootEmpty = count == 0;
+    }
+    LOG_DEBUGF(L"Destination snapshot: {} existing entries in {}\\{}", count, m_root, directoryKey);
+}
+
+void DestinationSnapshot::ListParent(const std::wstring& key) const
+{
+    size_t separator = key.find_last_of(L'\\');
+    ListDirectory(separator == std::wstring::npos ? std::wstring() : key.substr(0, separator));
+}
+
+bool DestinationSnapshot::IsEmpty() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ListDirectory(std::wstring());
+    return m_rootEmpty;
+}
+
+bool DestinationSnapshot::Contains(std::wstring_view relativePath) const
+{
+    std::wstring key = MakeKey(relativePath);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ListParent(key);
+    return m_paths.count(key) > 0;
+}
+
+std::wstring DestinationSnapshot::ReserveUnique(std::wstring_view relativePath)
+{
+    // "dir\stem.ext" -> "dir\stem (n).ext"; a leading dot is part of the stem
+    size_t separator = relativePath.find_last_of(L'\\');
+    size_t nameStart = separator == std::wstring_view::npos ? 0 : separator + 1;
+    size_t dot = relativePath.find_last_of(L'.');
+    if (dot == std::wstring_view::npos || dot <= nameStart)
+    {
+        dot = relativePath.size();
+    }
+
+    std::wstring_view stem = relativePath.substr(0, dot);
+    std::wstring_view extension = relativePath.substr(dot);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (uint32_t n = 1;; n++)
+    {
+        std::wstring candidate = std::wstring(stem) + L" (" + std::to_wstring(n) + L")" + std::wstring(extension);
+        std::wstring key = MakeKey(candidate);
+        ListParent(key);
+        if (m_paths.insert(key).second)
+        {
+            return candidate;
+        }
+    }
+}
+
+std::vector<std::wstring> DestinationSnapshot::FindConflicts(const ArchiveIndex& index, const EntrySelector& selector,
+                                                             const PathValidator& validator) const
+{
+    std::vector<std::wstring> conflicts;
+    if (IsEmpty())
+    {
+        return conflicts;
+    }
+
+    std::wstring entryPath;
+    std::wstring relativePath;
+    for (size_t i = 0; i < index.GetEntryCount(); i++)
+    {
+        const ArchiveIndexEntry& entry = index.GetEntry(i);
+        std::string_view name = index.GetName(entry);
+        if (entry.IsDirectory() || (!selector.IsEmpty() && !selector.Matches(name)))
+        {
+            continue;
+        }
+
+        Utf8::DecodeEntryName(name, entryPath);
+        if (validator.Resolve(entryPath, relativePath) && Contains(relativePath))
+        {
+            conflicts.push_back(relativePath);
+        }
+    }
+    return conflicts;
+}
+
+OverwritePolicy DestinationSnapshot::ResolvePolicy(OverwritePolicy policy, const ArchiveInfo& info, const EntrySelector& selector,
+                                                   const PathValidator& validator, IProgressCallback* callback) const
+{
+    if (policy != OverwritePolicy::Prompt)
+    {
+        return policy;
+    }
+
+    // The conflicts are known up front from the entry index, so the user is
+    // asked once instead of the decoder stopping at every existing file
+    if (!info.index)
+    {
+        LOG_WARNING(L"No entry index to list conflicts; existing files will be kept and new ones renamed");
+        return OverwritePolicy::AutoRename;
+    }
+
+    std::vector<std::wstring> conflicts = FindConflicts(*info.index, selector, validator);
+    if (conflicts.empty() || !callback)
+    {
+        return OverwritePolicy::AutoRename;
+    }
+
+    LOG_INFO(L"Asking how to resolve " + std::to_wstring(conflicts.size()) + L" conflicting files");
+    OverwritePolicy resolved = callback->ResolveConflicts(conflicts);
+    return resolved == OverwritePolicy::Prompt ? OverwritePolicy::AutoRename : resolved;
+}
+
+std::wstring DestinationSnapshot::MakeKey(std::wstring_view relativePath)
+{
+    std::wstring key(relativePath);
+    for (wchar_t& c : key)
+    {
+        c = static_cast<wchar_t>(std::towupper(c));
+    }
+    return key;
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,69 @@
+#pragma once
+#include "../Core/ExtractionOptions.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace ZipSpark {
+
+struct ArchiveInfo;
+class ArchiveIndex;
+class EntrySelector;
+class IProgressCallback;
+class PathValidator;
+
+/// <summary>
+/// Paths already present under the extraction root.
+/// A directory is listed once, the first time a lookup touches it (one
+/// directory listing, no per-file stat), so OverwritePolicy decisions are
+/// hash lookups and only the directories the archive writes to are read: the
+/// root may be a large folder such as Downloads. Lookups must reach a
+/// directory before anything is extracted into it, as the engines' per-entry
+/// checks do. Paths are relative and '\' separated as produced by
+/// PathValidator, and compared case-insensitively like NTFS. Safe to use
+/// from several threads.
+/// </summary>
+class DestinationSnapshot
+{
+public:
+    explicit DestinationSnapshot(const std::wstring& root);
+
+    // Nothing in the root directory (or no root), so nothing can conflict
+    bool IsEmpty() const;
+
+    bool Contains(std::wstring_view relativePath) const;
+
+    // First free "name (n).ext" next to relativePath; reserved so no other entry gets it
+    std::wstring ReserveUnique(std::wstring_view relativePath);
+
+    // Files of an archive (restricted to a selection) that already exist, as relative paths
+    std::vector<std::wstring> FindConflicts(const ArchiveIndex& index, const EntrySelector& selector,
+                                            const PathValidator& validator) const;
+
+    // Turn Prompt into a concrete policy with one ResolveConflicts call for all
+    // conflicts (none if nothing conflicts); other policies are returned as is
+    OverwritePolicy ResolvePolicy(OverwritePolicy policy, const ArchiveInfo& info, const EntrySelector& selector,
+                                  const PathValidator& validator, IProgressCallback* callback) const;
+
+private:
+    DestinationSnapshot(const DestinationSnapshot&) = delete;
+    DestinationSnapshot& operator=(const DestinationSnapshot&) = delete;
+
+    static std::wstring MakeKey(std::wstring_view relativePath);
+
+    // Add a directory's entries unless it was listed already (m_mutex held)
+    void ListDirectory(const std::wstring& directoryKey) const;
+    // List the directory a key lives in (m_mutex held)
+    void ListParent(const std::wstring& key) const;
+
+    std::wstring m_root;
+    mutable std::mutex m_mutex;
+    mutable std::unordered_set<std::wstring> m_paths;   // Upper-cased relative paths
+    mutable std::unordered_set<std::wstring> m_listed;  // Upper-cased directories already listed
+    mutable bool m_rootEmpty = true;                    // Set when the root is listed
+};
+
+} // namespace ZipSpark
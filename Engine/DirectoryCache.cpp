@@ -0,0 +1,303 @@
+#include "pch.h"
+#include "DirectoryCache.h"
+#include "../Utils/Logger.h"
+#include <winternl.h>
+
+#ifndef NT_SUCCESS
+#define NT_SUCCESS(status) (((NTSTATUS)(status)) >= 0)
+#endif
+#ifndef FILE_SEQUENTIAL_ONLY
+#define FILE_SEQUENTIAL_ONLY 0x00000004
+#endif
+#ifndef FILE_NO_INTERMEDIATE_BUFFERING
+#define FILE_NO_INTERMEDIATE_BUFFERING 0x00000008
+#endif
+#ifndef FILE_OPEN_REPARSE_POINT
+#define FILE_OPEN_REPARSE_POINT 0x00200000
+#endif
+
+namespace ZipSpark {
+
+// ntdll entry points, resolved once. NtCreateFile is the only Win32-reachable
+// way to create a file relative to a directory handle.
+typedef NTSTATUS (NTAPI *NtCreateFileFn)(PHANDLE, ACCESS_MASK, POBJECT_ATTRIBUTES, PIO_STATUS_BLOCK,
+                                         PLARGE_INTEGER, ULONG, ULONG, ULONG, ULONG, PVOID, ULONG);
+typedef ULONG (NTAPI *RtlNtStatusToDosErrorFn)(NTSTATUS);
+
+struct NtApi
+{
+    NtCreateFileFn createFile = nullptr;
+    RtlNtStatusToDosErrorFn toDosError = nullptr;
+};
+
+static const NtApi& GetNtApi()
+{
+    static const NtApi api = []() {
+        NtApi result;
+        HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+        if (ntdll)
+        {
+            result.createFile = reinterpret_cast<NtCreateFileFn>(GetProcAddress(ntdll, "NtCreateFile"));
+            result.toDosError = reinterpret_cast<RtlNtStatusToDosErrorFn>(GetProcAddress(ntdll, "RtlNtStatusToDosError"));
+        }
+        return result;
+    }();
+    return api;
+}
+
+constexpr DWORD DIRECTORY_ACCESS = FILE_LIST_DIRECTORY | FILE_TRAVERSE | FILE_READ_ATTRIBUTES | SYNCHRONIZE;
+constexpr DWORD FILE_ACCESS = FILE_GENERIC_WRITE | FILE_READ_ATTRIBUTES | DELETE; // DELETE for OutputFile::Discard
+constexpr DWORD SHARE_ALL = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+
+// Symlinks, junctions and mount points already under the destination would
+// redirect writes outside it. Everything below the root is opened as the
+// link itself and refused if it is one; a failed query counts as a link.
+static bool IsReparsePoint(HANDLE handle)
+{
+    BY_HANDLE_FILE_INFORMATION info = {};
+    return !GetFileInformationByHandle(handle, &info) || (info.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+}
+
+DirectoryCache::DirectoryHandle::~DirectoryHandle()
+{
+    if (handle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(handle);
+    }
+}
+
+DirectoryCache::DirectoryCache(const std::wstring& root, size_t maxOpenHandles)
+    : m_root(root)
+    , m_maxOpenHandles(std::max<size_t>(maxOpenHandles, 1))
+{
+    while (!m_root.empty() && (m_root.back() == L'\\' || m_root.back() == L'/'))
+    {
+        m_root.pop_back();
+    }
+}
+
+DirectoryCache::~DirectoryCache()
+{
+}
+
+bool DirectoryCache::EnsureDirectory(std::wstring_view relativeDir)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_existing.count(std::wstring(relativeDir)) > 0)
+        {
+            return true;
+        }
+    }
+    return AcquireDirectory(relativeDir) != nullptr;
+}
+
+HANDLE DirectoryCache::CreateFileForWrite(std::wstring_view relativePath, bool unbuffered, bool asynchronous)
+{
+    size_t separator = relativePath.find_last_of(L'\\');
+    std::wstring_view parentDir = separator == std::wstring_view::npos ? std::wstring_view() : relativePath.substr(0, separator);
+    std::wstring_view name = separator == std::wstring_view::npos ? relativePath : relativePath.substr(separator + 1);
+
+    DirectoryHandlePtr parent = AcquireDirectory(parentDir);
+    if (!parent)
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+    return CreateRelative(parent->handle, relativePath, name, false, unbuffered, asynchronous);
+}
+
+bool DirectoryCache::OpenOutputFile(std::wstring_view relativePath, bool sparse, int64_t length,
+                                    const ExtractionOptions& options, OutputFile& file, bool asynchronous)
+{
+    // Very large entries would only evict everything else from the file cache.
+    // Sparse entries are excluded: their writes are not sequential.
+    bool unbuffered = !sparse && length > 0 && options.unbufferedWriteThreshold > 0 &&
+                      static_cast<uint64_t>(length) >= options.unbufferedWriteThreshold;
+
+    HANDLE handle = CreateFileForWrite(relativePath, unbuffered, asynchronous);
+    if (handle == INVALID_HANDLE_VALUE && unbuffered)
+    {
+        unbuffered = false;
+        handle = CreateFileForWrite(relativePath, false, asynchronous);
+    }
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    file = OutputFile(handle, options.writeBufferSize, unbuffered);
+
+    if (sparse)
+    {
+        if (!file.MarkSparse())
+        {
+            LOG_WARNING(L"Volume does not support sparse files, holes will be allocated: " + std::wstring(relativePath));
+        }
+    }
+    else if (length > 0 && !file.Preallocate(static_cast<uint64_t>(length)))
+    {
+        // Only a full disk is fatal; other volumes may just not support the hint
+        DWORD error = GetLastError();
+        if (error == ERROR_DISK_FULL || error == ERROR_HANDLE_DISK_FULL)
+        {
+            file.Close();
+            SetLastError(ERROR_DISK_FULL);
+            return false;
+        }
+    }
+    return true;
+}
+
+DirectoryCache::DirectoryHandlePtr DirectoryCache::AcquireDirectory(std::wstring_view relativeDir)
+{
+    std::wstring key(relativeDir);
+    if (DirectoryHandlePtr cached = LookupHandle(key))
+    {
+        return cached;
+    }
+
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    if (key.empty())
+    {
+        // The extraction root itself (created by the engine before extraction)
+        handle = CreateFileW(m_root.c_str(), DIRECTORY_ACCESS, SHARE_ALL, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    }
+    else
+    {
+        size_t separator = key.find_last_of(L'\\');
+        std::wstring_view parentDir = separator == std::wstring::npos ? std::wstring_view() : relativeDir.substr(0, separator);
+        std::wstring_view name = separator == std::wstring::npos ? relativeDir : relativeDir.substr(separator + 1);
+
+        DirectoryHandlePtr parent = AcquireDirectory(parentDir);
+        if (!parent)
+        {
+            return nullptr;
+        }
+        handle = CreateRelative(parent->handle, relativeDir, name, true);
+    }
+
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        LOG_ERROR(L"Failed to create directory: " + m_root + L"\\" + key + L" (error " + std::to_wstring(GetLastError()) + L")");
+        return nullptr;
+    }
+
+    auto directory = std::make_shared<DirectoryHandle>(handle);
+    CacheHandle(key, directory);
+    return directory;
+}
+
+DirectoryCache::DirectoryHandlePtr DirectoryCache::LookupHandle(const std::wstring& relativeDir)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_handles.find(relativeDir);
+    if (it == m_handles.end())
+    {
+        return nullptr;
+    }
+
+    // Move to the front of the LRU list
+    m_lru.splice(m_lru.begin(), m_lru, it->second.second);
+    return it->second.first;
+}
+
+void DirectoryCache::CacheHandle(const std::wstring& relativeDir, const DirectoryHandlePtr& handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_existing.insert(relativeDir);
+
+    // Another thread may have opened the same directory meanwhile; keep theirs
+    if (m_handles.count(relativeDir) > 0)
+    {
+        return;
+    }
+
+    m_lru.push_front(relativeDir);
+    m_handles.emplace(relativeDir, std::make_pair(handle, m_lru.begin()));
+
+    // Evict the coldest handles; in-flight users keep theirs alive via shared_ptr
+    while (m_handles.size() > m_maxOpenHandles)
+    {
+        m_handles.erase(m_lru.back());
+        m_lru.pop_back();
+    }
+}
+
+HANDLE DirectoryCache::CreateRelative(HANDLE parent, std::wstring_view relativePath, std::wstring_view name, bool directory,
+                                      bool unbuffered, bool asynchronous)
+{
+    const NtApi& nt = GetNtApi();
+    HANDLE handle = INVALID_HANDLE_VALUE;
+
+    if (!nt.createFile || name.size() * sizeof(wchar_t) > 0xFFFE)
+    {
+        // Full-path fallback
+        std::wstring fullPath = m_root + L"\\" + std::wstring(relativePath);
+        if (directory)
+        {
+            if (!CreateDirectoryW(fullPath.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+            {
+                return INVALID_HANDLE_VALUE;
+            }
+            handle = CreateFileW(fullPath.c_str(), DIRECTORY_ACCESS, SHARE_ALL, nullptr, OPEN_EXISTING,
+                                 FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OPEN_REPARSE_POINT, nullptr);
+        }
+        else
+        {
+            handle = CreateFileW(fullPath.c_str(), GENERIC_WRITE | FILE_READ_ATTRIBUTES | DELETE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OPEN_REPARSE_POINT |
+                                 (unbuffered ? FILE_FLAG_NO_BUFFERING : 0) | (asynchronous ? FILE_FLAG_OVERLAPPED : 0), nullptr);
+        }
+        return RefuseReparsePoint(handle, relativePath);
+    }
+
+    UNICODE_STRING objectName;
+    objectName.Buffer = const_cast<PWSTR>(name.data());
+    objectName.Length = static_cast<USHORT>(name.size() * sizeof(wchar_t));
+    objectName.MaximumLength = objectName.Length;
+
+    OBJECT_ATTRIBUTES attributes;
+    InitializeObjectAttributes(&attributes, &objectName, OBJ_CASE_INSENSITIVE, parent, nullptr);
+
+    IO_STATUS_BLOCK ioStatus = {};
+    NTSTATUS status;
+
+    if (directory)
+    {
+        // mkdirat + open in one call
+        status = nt.createFile(&handle, DIRECTORY_ACCESS, &attributes, &ioStatus, nullptr,
+                               FILE_ATTRIBUTE_DIRECTORY, SHARE_ALL, FILE_OPEN_IF,
+                               FILE_DIRECTORY_FILE | FILE_SYNCHRONOUS_IO_NONALERT | FILE_OPEN_REPARSE_POINT, nullptr, 0);
+    }
+    else
+    {
+        // Without FILE_SYNCHRONOUS_IO_NONALERT the handle is asynchronous (overlapped)
+        status = nt.createFile(&handle, FILE_ACCESS, &attributes, &ioStatus, nullptr,
+                               FILE_ATTRIBUTE_NORMAL, FILE_SHARE_READ, FILE_OVERWRITE_IF,
+                               FILE_NON_DIRECTORY_FILE | FILE_SEQUENTIAL_ONLY | FILE_OPEN_REPARSE_POINT |
+                               (asynchronous ? 0 : FILE_SYNCHRONOUS_IO_NONALERT) |
+                               (unbuffered ? FILE_NO_INTERMEDIATE_BUFFERING : 0), nullptr, 0);
+    }
+
+    if (!NT_SUCCESS(status))
+    {
+        SetLastError(nt.toDosError ? nt.toDosError(status) : ERROR_ACCESS_DENIED);
+        return INVALID_HANDLE_VALUE;
+    }
+    return RefuseReparsePoint(handle, relativePath);
+}
+
+HANDLE DirectoryCache::RefuseReparsePoint(HANDLE handle, std::wstring_view relativePath)
+{
+    if (handle != INVALID_HANDLE_VALUE && IsReparsePoint(handle))
+    {
+        CloseHandle(handle);
+        LOG_WARNING(L"Security Warning: Not following a link in the destination: " + m_root + L"\\" + std::wstring(relativePath));
+        SetLastError(ERROR_STOPPED_ON_SYMLINK);
+        return INVALID_HANDLE_VALUE;
+    }
+    return handle;
+}
+
+} // namespace ZipSpark
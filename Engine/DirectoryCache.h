@@ -0,0 +1,87 @@
+#pragma once
+#include "OutputFile.h"
+#include "../Core/ExtractionOptions.h"
+#include <windows.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Extraction-tree cache.
+/// Remembers which directories under the extraction root already exist and
+/// keeps handles to recently used ones open. Files and subdirectories are
+/// created relative to their parent's handle (NtCreateFile with a
+/// RootDirectory, the Windows counterpart of openat/mkdirat), so the kernel
+/// never re-walks the full path of deep trees.
+/// Relative paths must be normalized ('\' separated, no "." or ".."),
+/// as produced by PathValidator. Links (symlinks, junctions, mount points)
+/// found below the root are never followed: opening one fails with
+/// ERROR_STOPPED_ON_SYMLINK. Safe to use from several threads.
+/// </summary>
+class DirectoryCache
+{
+public:
+    explicit DirectoryCache(const std::wstring& root, size_t maxOpenHandles = 64);
+    ~DirectoryCache();
+
+    // Make sure a directory exists, creating missing components
+    bool EnsureDirectory(std::wstring_view relativeDir);
+
+    // Create or truncate a file for writing; creates its parent directories.
+    // unbuffered bypasses the system cache (writes must be sector aligned).
+    // asynchronous opens the handle for overlapped I/O.
+    // Returns INVALID_HANDLE_VALUE on failure (GetLastError is set).
+    HANDLE CreateFileForWrite(std::wstring_view relativePath, bool unbuffered = false, bool asynchronous = false);
+
+    // Create the writer for an extracted entry of the given final length (-1 if
+    // unknown): sparse marking, write buffer, unbuffered I/O for large entries
+    // and preallocation. Returns false on failure (GetLastError is set;
+    // ERROR_DISK_FULL means the entry does not fit).
+    // An asynchronous file is only written through an I/O ring (see
+    // IoRingBackend): on a synchronous handle the ring runs each write inline.
+    bool OpenOutputFile(std::wstring_view relativePath, bool sparse, int64_t length,
+                        const ExtractionOptions& options, OutputFile& file, bool asynchronous = false);
+
+    const std::wstring& GetRoot() const { return m_root; }
+
+private:
+    DirectoryCache(const DirectoryCache&) = delete;
+    DirectoryCache& operator=(const DirectoryCache&) = delete;
+
+    // Open directory handle; closed when the last user releases it
+    struct DirectoryHandle
+    {
+        explicit DirectoryHandle(HANDLE handle) : handle(handle) {}
+        ~DirectoryHandle();
+        HANDLE handle;
+    };
+    using DirectoryHandlePtr = std::shared_ptr<DirectoryHandle>;
+
+    // Handle to a directory, creating it (and its parents) if needed
+    DirectoryHandlePtr AcquireDirectory(std::wstring_view relativeDir);
+    DirectoryHandlePtr LookupHandle(const std::wstring& relativeDir);
+    void CacheHandle(const std::wstring& relativeDir, const DirectoryHandlePtr& handle);
+
+    // NtCreateFile relative to parent; falls back to a full path if ntdll is unavailable
+    HANDLE CreateRelative(HANDLE parent, std::wstring_view relativeDir, std::wstring_view name, bool directory,
+                          bool unbuffered = false, bool asynchronous = false);
+    // Close handle and fail if it is a link instead of a real file or directory
+    HANDLE RefuseReparsePoint(HANDLE handle, std::wstring_view relativePath);
+
+    std::wstring m_root;
+    size_t m_maxOpenHandles;
+
+    std::mutex m_mutex;
+    std::unordered_set<std::wstring> m_existing;
+    std::list<std::wstring> m_lru; // Most recently used first
+    std::unordered_map<std::wstring, std::pair<DirectoryHandlePtr, std::list<std::wstring>::iterator>> m_handles;
+};
+
+} // namespace ZipSpark
@@ -1,6 +1,6 @@
 #include "pch.h"
 #include "EngineFactory.h"
-#include "SevenZipEngine.h"
+#include "WorkerProcessEngine.h"
 #include "../Utils/Logger.h"
 #include <filesystem>
 #include <algorithm>
@@ -46,8 +46,8 @@ std::unique_ptr<IExtractionEngine> EngineFactory::CreateEngine(const std::wstrin
     case ArchiveFormat::TAR_GZ:
     case ArchiveFormat::TAR_XZ:
     case ArchiveFormat::XZ:
-        // Use 7-Zip process isolation for maximum stability and format support
-        return std::make_unique<SevenZipEngine>();
+        // Pooled worker processes keep crashes isolated; 7-Zip covers the rest
+        return std::make_unique<WorkerProcessEngine>();
         
     default:
         LOG_ERROR(L"Unknown archive format: " + archivePath);
@@ -0,0 +1,199 @@
+#include "pch.h"
+#include "EntrySelector.h"
+#include "../Utils/Utf8.h"
+
+namespace ZipSpark {
+
+static bool IsSeparator(char ch)
+{
+    return ch == '/' || ch == '\\';
+}
+
+// Strip leading separators and "./" components
+static std::string_view TrimLeading(std::string_view path)
+{
+    for (;;)
+    {
+        if (!path.empty() && IsSeparator(path.front()))
+        {
+            path.remove_prefix(1);
+        }
+        else if (path.size() >= 2 && path[0] == '.' && IsSeparator(path[1]))
+        {
+            path.remove_prefix(2);
+        }
+        else
+        {
+            return path;
+        }
+    }
+}
+
+// Next non-empty component of path, advancing it
+static bool NextComponent(std::string_view& path, std::string_view& component)
+{
+    while (!path.empty() && IsSeparator(path.front()))
+    {
+        path.remove_prefix(1);
+    }
+    if (path.empty())
+    {
+        return false;
+    }
+
+    size_t length = 0;
+    while (length < path.size() && !IsSeparator(path[length]))
+    {
+        length++;
+    }
+    component = path.substr(0, length);
+    path.remove_prefix(length);
+    return true;
+}
+
+EntrySelector::EntrySelector(const std::vector<std::wstring>& selection)
+{
+    for (const auto& item : selection)
+    {
+        std::string path = Utf8::FromWide(item);
+        if (TrimLeading(path).empty())
+        {
+            continue;
+        }
+        m_empty = false;
+
+        if (path.find_first_of("*?") != std::string::npos)
+        {
+            // Globs are matched component-aware, so normalize separators once
+            std::string pattern(TrimLeading(path));
+            for (char& ch : pattern)
+            {
+                if (ch == '\\') ch = '/';
+            }
+            while (!pattern.empty() && pattern.back() == '/')
+            {
+                pattern.pop_back();
+            }
+            m_globs.push_back(std::move(pattern));
+        }
+        else
+        {
+            AddPath(path);
+        }
+    }
+}
+
+void EntrySelector::AddPath(const std::string& path)
+{
+    std::string_view rest = TrimLeading(path);
+    std::string_view component;
+    Node* node = &m_root;
+
+    while (NextComponent(rest, component))
+    {
+        auto& child = node->children[std::string(component)];
+        if (!child)
+        {
+            child = std::make_unique<Node>();
+        }
+        node = child.get();
+    }
+    node->selected = true;
+}
+
+bool EntrySelector::Matches(std::string_view entryPath) const
+{
+    if (m_empty)
+    {
+        return true;
+    }
+
+    std::string_view rest = TrimLeading(entryPath);
+
+    // Trie: selected if this path or one of its ancestors was selected
+    const Node* node = &m_root;
+    std::string_view walk = rest;
+    std::string_view component;
+    std::string key;
+    while (!m_root.children.empty() && NextComponent(walk, component))
+    {
+        key.assign(component.data(), component.size());
+        auto it = node->children.find(key);
+        if (it == node->children.end())
+        {
+            break;
+        }
+        node = it->second.get();
+        if (node->selected)
+        {
+            return true;
+        }
+    }
+
+    if (m_globs.empty())
+    {
+        return false;
+    }
+
+    // Globs: test the path and each ancestor, so "docs/*" also takes "docs/a/b.txt"
+    std::string normalized(rest);
+    for (char& ch : normalized)
+    {
+        if (ch == '\\') ch = '/';
+    }
+    while (!normalized.empty() && normalized.back() == '/')
+    {
+        normalized.pop_back();
+    }
+
+    for (size_t end = normalized.size(); end != std::string::npos && end > 0; end = normalized.rfind('/', end - 1))
+    {
+        std::string_view prefix(normalized.data(), end);
+        for (const auto& glob : m_globs)
+        {
+            if (GlobMatch(glob, prefix))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool EntrySelector::GlobMatch(std::string_view pattern, std::string_view path)
+{
+    // Iterative wildcard match with single-star backtracking; '*' does not cross '/'
+    size_t p = 0, s = 0;
+    size_t starPattern = std::string_view::npos, starPath = 0;
+
+    while (s < path.size())
+    {
+        if (p < pattern.size() && (pattern[p] == path[s] || (pattern[p] == '?' && path[s] != '/')))
+        {
+            p++;
+            s++;
+        }
+        else if (p < pattern.size() && pattern[p] == '*')
+        {
+            starPattern = p++;
+            starPath = s;
+        }
+        else if (starPattern != std::string_view::npos && path[starPath] != '/')
+        {
+            p = starPattern + 1;
+            s = ++starPath;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*')
+    {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+} // namespace ZipSpark
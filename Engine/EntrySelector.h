@@ -0,0 +1,44 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Compiled extraction selection.
+/// Plain paths go into a trie over path components; an entry matches when it
+/// is a selected path or lies under one, so selecting a folder selects its
+/// contents. Paths with '*' or '?' are matched as globs ('*' stops at '/').
+/// Matching works on the raw UTF-8 entry path, with '\' and '/' equivalent
+/// and leading "./" ignored, so unselected entries cost no conversion.
+/// </summary>
+class EntrySelector
+{
+public:
+    EntrySelector() = default;
+    explicit EntrySelector(const std::vector<std::wstring>& selection);
+
+    // No selection: everything matches
+    bool IsEmpty() const { return m_empty; }
+
+    bool Matches(std::string_view entryPath) const;
+
+private:
+    struct Node
+    {
+        bool selected = false;
+        std::unordered_map<std::string, std::unique_ptr<Node>> children;
+    };
+
+    void AddPath(const std::string& path);
+    static bool GlobMatch(std::string_view pattern, std::string_view path);
+
+    bool m_empty = true;
+    Node m_root;
+    std::vector<std::string> m_globs;
+};
+
+} // namespace ZipSpark
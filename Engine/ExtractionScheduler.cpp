@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "ExtractionScheduler.h"
+#include <algorithm>
+
+namespace ZipSpark {
+
+// Small entries are grouped until a run reaches this many bytes or entries
+constexpr uint64_t MIN_TASK_BYTES = 1024 * 1024; // 1 MB
+constexpr uint32_t MAX_TASK_ENTRIES = 512;
+
+// Tasks per worker we aim for, so stealing has something left to balance with
+constexpr uint64_t TASKS_PER_WORKER = 16;
+
+std::vector<EntryTask> ExtractionScheduler::BuildTasks(const std::vector<uint64_t>& entrySizes, uint32_t workerCount)
+{
+    std::vector<EntryTask> tasks;
+    if (entrySizes.empty())
+    {
+        return tasks;
+    }
+
+    uint64_t totalBytes = 0;
+    for (uint64_t size : entrySizes)
+    {
+        totalBytes += size;
+    }
+
+    uint64_t targetBytes = totalBytes / (std::max<uint32_t>(workerCount, 1) * TASKS_PER_WORKER);
+    targetBytes = std::max(targetBytes, MIN_TASK_BYTES);
+
+    EntryTask current;
+    bool hasCurrent = false;
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(entrySizes.size()); i++)
+    {
+        uint64_t size = entrySizes[i];
+
+        // Large entries get a task of their own so they can be scheduled first
+        if (size >= targetBytes)
+        {
+            if (hasCurrent)
+            {
+                tasks.push_back(current);
+                hasCurrent = false;
+            }
+            tasks.push_back({ i, i, size });
+            continue;
+        }
+
+        if (!hasCurrent)
+        {
+            current = { i, i, 0 };
+            hasCurrent = true;
+        }
+
+        current.lastEntry = i;
+        current.totalBytes += size;
+
+        if (current.totalBytes >= targetBytes || (current.lastEntry - current.firstEntry + 1) >= MAX_TASK_ENTRIES)
+        {
+            tasks.push_back(current);
+            hasCurrent = false;
+        }
+    }
+
+    if (hasCurrent)
+    {
+        tasks.push_back(current);
+    }
+
+    return tasks;
+}
+
+ExtractionScheduler::ExtractionScheduler(std::vector<EntryTask> tasks, uint32_t workerCount)
+{
+    workerCount = std::max<uint32_t>(workerCount, 1);
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    // Largest task first, each to the currently least loaded worker (LPT),
+    // so every worker starts with roughly the same number of bytes
+    std::sort(tasks.begin(), tasks.end(), [](const EntryTask& a, const EntryTask& b) {
+        return a.totalBytes > b.totalBytes;
+    });
+
+    std::vector<uint64_t> load(workerCount, 0);
+    for (const auto& task : tasks)
+    {
+        size_t target = std::min_element(load.begin(), load.end()) - load.begin();
+        load[target] += std::max<uint64_t>(task.totalBytes, 1);
+        m_queues[target]->tasks.push_back(task);
+    }
+
+    // Readers only move forward cheaply, so each worker walks its own share in
+    // archive order. Thieves take from the back, which keeps the owner moving forward.
+    for (auto& queue : m_queues)
+    {
+        std::sort(queue->tasks.begin(), queue->tasks.end(), [](const EntryTask& a, const EntryTask& b) {
+            return a.firstEntry < b.firstEntry;
+        });
+    }
+}
+
+bool ExtractionScheduler::Next(uint32_t workerIndex, EntryTask& task)
+{
+    uint32_t workerCount = GetWorkerCount();
+
+    // Own queue first
+    {
+        WorkerQueue& own = *m_queues[workerIndex % workerCount];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Steal from the other workers
+    for (uint32_t offset = 1; offset < workerCount; offset++)
+    {
+        WorkerQueue& victim = *m_queues[(workerIndex + offset) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ZipSpark {
+
+/// <summary>
+/// A contiguous run of archive entries extracted by one worker.
+/// Entry indices are the order in which archive_read_next_header returns them.
+/// </summary>
+struct EntryTask
+{
+    uint32_t firstEntry = 0;
+    uint32_t lastEntry = 0;   // Inclusive
+    uint64_t totalBytes = 0;  // Uncompressed bytes covered by the run
+};
+
+/// <summary>
+/// Work-stealing scheduler for parallel per-entry extraction.
+/// Tasks are dealt largest-first across per-worker queues so the queues start
+/// with balanced byte totals; idle workers then steal from the others.
+/// </summary>
+class ExtractionScheduler
+{
+public:
+    ExtractionScheduler(std::vector<EntryTask> tasks, uint32_t workerCount);
+
+    // Split entries into tasks: large entries stand alone, small neighbours are grouped
+    static std::vector<EntryTask> BuildTasks(const std::vector<uint64_t>& entrySizes, uint32_t workerCount);
+
+    // Get the next task for a worker. Returns false when all queues are drained.
+    bool Next(uint32_t workerIndex, EntryTask& task);
+
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_queues.size()); }
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<EntryTask> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+};
+
+} // namespace ZipSpark
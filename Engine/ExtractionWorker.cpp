@@ -0,0 +1,198 @@
+#include "pch.h"
+#include "ExtractionWorker.h"
+#include "ArchiveScanner.h"
+#include "LibArchiveEngine.h"
+#include "WorkerProtocol.h"
+#include "../Utils/ArchiveIndexCache.h"
+#include "../Utils/Logger.h"
+#include <cwchar>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Writes the engine's callbacks to stdout as protocol messages. Progress
+/// arrives from the engine's progress thread while file events come from
+/// its workers, so each message is written whole under a lock.
+/// </summary>
+class WorkerCallback : public IProgressCallback
+{
+public:
+    WorkerCallback() : m_output(GetStdHandle(STD_OUTPUT_HANDLE)) {}
+
+    void Reset() { m_finished = false; }
+    bool IsFinished() const { return m_finished; }
+
+    void OnStart(int totalFiles) override
+    {
+        Send({ L"START", std::to_wstring(totalFiles) });
+    }
+
+    void OnProgress(int percentComplete, uint64_t bytesProcessed, uint64_t totalBytes) override
+    {
+        Send({ L"PROGRESS", std::to_wstring(percentComplete), std::to_wstring(bytesProcessed), std::to_wstring(totalBytes) });
+    }
+
+    void OnFileProgress(const std::wstring& currentFile, int fileIndex, int totalFiles) override
+    {
+        Send({ L"FILE", std::to_wstring(fileIndex), std::to_wstring(totalFiles), currentFile });
+    }
+
+    void OnComplete(const std::wstring& destination) override
+    {
+        Send({ L"COMPLETE", destination });
+        m_finished = true;
+    }
+
+    void OnError(ErrorCode errorCode, const std::wstring& errorMessage) override
+    {
+        Send({ L"ERROR", std::to_wstring(static_cast<int>(errorCode)), errorMessage });
+        m_finished = true;
+    }
+
+    // Result of a SCAN request
+    void OnScanned(bool complete, const ArchiveInfo& info)
+    {
+        Send({ L"SCANNED", complete ? L"1" : L"0", std::to_wstring(info.fileCount), std::to_wstring(info.directoryCount),
+               std::to_wstring(info.totalSize), info.isEncrypted ? L"1" : L"0", info.hasSingleRoot ? L"1" : L"0" });
+    }
+
+private:
+    void Send(std::initializer_list<std::wstring_view> fields)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_line.clear();
+        WorkerProtocol::AppendMessage(m_line, fields);
+
+        DWORD written = 0;
+        WriteFile(m_output, m_line.data(), static_cast<DWORD>(m_line.size()), &written, nullptr);
+    }
+
+    HANDLE m_output;
+    std::mutex m_mutex;
+    std::string m_line;
+    std::atomic<bool> m_finished{false};
+};
+
+static uint64_t ToNumber(const std::wstring& field)
+{
+    return std::wcstoull(field.c_str(), nullptr, 10);
+}
+
+// EXTRACT archive destination policy timestamps permissions threads bufferSize writeBufferSize
+//         unbufferedThreshold pipelineLimit writeBackend mapLimit cacheToMemory memoryBudget [selection...]
+static void RunJob(const std::vector<std::wstring>& fields, WorkerCallback& callback)
+{
+    callback.Reset();
+    if (fields.size() < 15)
+    {
+        LOG_ERROR(L"Malformed extraction request");
+        callback.OnError(ErrorCode::UnknownError, L"Malformed extraction request");
+        return;
+    }
+
+    // The parent settled the destination and any Prompt policy already
+    ExtractionOptions options;
+    options.destinationPath = fields[2];
+    options.overwritePolicy = static_cast<OverwritePolicy>(ToNumber(fields[3]));
+    options.preserveTimestamps = fields[4] == L"1";
+    options.preservePermissions = fields[5] == L"1";
+    options.threadCount = static_cast<uint32_t>(ToNumber(fields[6]));
+    options.bufferSize = static_cast<uint32_t>(ToNumber(fields[7]));
+    options.writeBufferSize = static_cast<uint32_t>(ToNumber(fields[8]));
+    options.unbufferedWriteThreshold = ToNumber(fields[9]);
+    options.pipelineMemoryLimit = ToNumber(fields[10]);
+    options.writeBackend = static_cast<WriteBackend>(ToNumber(fields[11]));
+    options.memoryMapLimit = ToNumber(fields[12]);
+    options.cacheToMemory = fields[13] == L"1";
+    options.memoryBudget = ToNumber(fields[14]);
+    options.selection.assign(fields.begin() + 15, fields.end());
+
+    // A worker scanned the headers moments ago, so this is an index cache hit
+    LibArchiveEngine engine;
+    ArchiveInfo info = engine.GetArchiveInfo(fields[1]);
+    engine.Extract(info, options, &callback);
+
+    // The engine returns silently in a few places (cancellation); every
+    // request still needs its final message
+    if (!callback.IsFinished())
+    {
+        callback.OnError(ErrorCode::ExtractionFailed, L"Extraction stopped without a result");
+    }
+}
+
+// SCAN archive: the header scan the app would otherwise run itself; the
+// entry table goes to the index cache, where the app and the EXTRACT that
+// follows find it. Where the full scan stops early, a quick one still
+// settles the root layout.
+static void RunScan(const std::vector<std::wstring>& fields, WorkerCallback& callback)
+{
+    ArchiveInfo info;
+    info.archivePath = fields[1];
+    bool complete = ArchiveScanner::Scan(info.archivePath, ArchiveScanner::Mode::Full, info);
+    if (!complete)
+    {
+        ArchiveScanner::Scan(info.archivePath, ArchiveScanner::Mode::Quick, info);
+    }
+    else if (info.index && info.index->GetEntryCount() < ArchiveIndexCache::MIN_CACHED_ENTRIES)
+    {
+        // The scanner keeps small tables to itself; the app needs this one
+        // for the overwrite prompt and for 7-Zip's sharding
+        ArchiveIndexCache::GetInstance().Store(info.archivePath, *info.index, true);
+    }
+    callback.OnScanned(complete, info);
+}
+
+bool ExtractionWorker::IsWorkerCommandLine(const wchar_t* commandLine)
+{
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(commandLine, &argc);
+    if (!argv)
+    {
+        return false;
+    }
+    bool isWorker = argc >= 2 && wcscmp(argv[1], WorkerProtocol::WORKER_SWITCH) == 0;
+    LocalFree(argv);
+    return isWorker;
+}
+
+int ExtractionWorker::Run()
+{
+    LOG_INFO(L"Extraction worker started");
+
+    HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+    WorkerCallback callback;
+    std::string buffer;
+    size_t consumed = 0;
+    std::vector<std::wstring> fields;
+    char chunk[4096];
+
+    // Requests run one at a time; the pool never sends another before the result
+    while (true)
+    {
+        std::string_view line;
+        while (WorkerProtocol::NextLine(buffer, consumed, line))
+        {
+            WorkerProtocol::Split(line, fields);
+            if (!fields.empty() && fields[0] == L"EXTRACT")
+            {
+                RunJob(fields, callback);
+            }
+            else if (fields.size() >= 2 && fields[0] == L"SCAN")
+            {
+                RunScan(fields, callback);
+            }
+        }
+
+        DWORD bytesRead = 0;
+        if (!ReadFile(input, chunk, sizeof(chunk), &bytesRead, nullptr) || bytesRead == 0)
+        {
+            break;
+        }
+        buffer.append(chunk, bytesRead);
+    }
+
+    LOG_INFO(L"Extraction worker exiting");
+    return 0;
+}
+
+} // namespace ZipSpark
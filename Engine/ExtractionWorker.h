@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Headless extraction worker: the app's own executable started with
+/// WorkerProtocol::WORKER_SWITCH. Takes EXTRACT requests on stdin, runs each
+/// through LibArchiveEngine and streams its callbacks back on stdout, and
+/// answers SCAN requests with an ArchiveScanner header scan. A crash
+/// in a decoder takes down only the worker; WorkerPool notices and starts a
+/// new one. Exits when stdin closes.
+/// </summary>
+class ExtractionWorker
+{
+public:
+    // Whether the process was started as a worker
+    static bool IsWorkerCommandLine(const wchar_t* commandLine);
+
+    // Serve requests until stdin closes; returns the process exit code
+    static int Run();
+};
+
+} // namespace ZipSpark
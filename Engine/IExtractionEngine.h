@@ -3,6 +3,7 @@
 #include "../Core/ExtractionOptions.h"
 #include "../Core/ExtractionProgress.h"
 #include "../Utils/ErrorHandler.h"
+#include "CompressionProfile.h"
 #include <string>
 
 namespace ZipSpark {
@@ -22,8 +23,8 @@ public:
     // Extract the archive
     virtual void Extract(const ArchiveInfo& info, const ExtractionOptions& options, IProgressCallback* callback) = 0;
 
-    // Create a new archive
-    virtual void CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>& sourceFiles, const std::wstring& format, IProgressCallback* callback) = 0;
+    // Create a new archive with the given compression settings
+    virtual void CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>& sourceFiles, const std::wstring& format, const CompressionProfile& profile, IProgressCallback* callback) = 0;
 
     // Cancel ongoing extraction
     virtual void Cancel() = 0;
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace ZipSpark {
+
+// Abstract interface for the write stage of a pipelined extraction.
+// The decoder thread queues file operations; the backend performs them
+// asynchronously, keeping each file's open, writes and close in order.
+class IOutputBackend
+{
+public:
+    virtual ~IOutputBackend() = default;
+
+    // Queue creation of a file (path relative to the directory cache root,
+    // final length or -1); returns the id used for its writes
+    virtual uint32_t BeginFile(const std::wstring& relativePath, bool sparse = false, int64_t length = -1) = 0;
+
+    // Copy a decoded block and queue it (blocks on backpressure)
+    virtual void Write(uint32_t fileId, const void* data, size_t size, int64_t offset) = 0;
+
+    // Queue the close of a file, truncating/extending it to length if known (>= 0)
+    virtual void EndFile(uint32_t fileId, int64_t length = -1) = 0;
+
+    // Queue the close of a file whose data is incomplete; the file is deleted
+    virtual void DiscardFile(uint32_t fileId) = 0;
+
+    // Drain all queued work. Returns false if any operation failed.
+    virtual bool Finish() = 0;
+
+    virtual bool HasFailed() const = 0;
+    virtual std::wstring GetError() = 0;
+
+    // Get backend name for logging
+    virtual std::wstring GetBackendName() const = 0;
+};
+
+} // namespace ZipSpark
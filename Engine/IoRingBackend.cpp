@@ -0,0 +1,450 @@
+#include "pch.h"
+#include "IoRingBackend.h"
+#include "DirectoryCache.h"
+#include "../Utils/Logger.h"
+#include <cstring>
+
+namespace ZipSpark {
+
+// Layouts of the ioringapi.h types. Declared here and resolved from
+// kernelbase.dll at run time, so neither the SDK nor the minimum OS
+// version has to include the I/O ring.
+enum RingRefKind : int32_t
+{
+    RING_REF_RAW = 0
+};
+
+struct RingHandleRef
+{
+    RingRefKind kind;
+    union
+    {
+        HANDLE handle;
+        UINT32 index;
+    };
+};
+
+struct RingBufferRef
+{
+    RingRefKind kind;
+    union
+    {
+        void* address;
+        struct
+        {
+            UINT32 index;
+            UINT32 offset;
+        } registered;
+    };
+};
+
+struct RingCreateFlags
+{
+    int32_t required;
+    int32_t advisory;
+};
+
+struct RingCompletion
+{
+    UINT_PTR userData;
+    HRESULT result;
+    ULONG_PTR information;
+};
+
+constexpr int32_t RING_VERSION_3 = 300;   // First version with file writes
+constexpr HRESULT RING_E_SUBMISSION_QUEUE_FULL = static_cast<HRESULT>(0x80460001);
+constexpr uint32_t RING_MAX_QUEUE = 1024;
+constexpr UINT32 RING_WAIT_MS = 10;
+
+typedef HRESULT (WINAPI *CreateIoRingFn)(int32_t, RingCreateFlags, UINT32, UINT32, void**);
+typedef HRESULT (WINAPI *BuildIoRingWriteFileFn)(void*, RingHandleRef, RingBufferRef, UINT32, UINT64, int32_t, UINT_PTR, int32_t);
+typedef HRESULT (WINAPI *SubmitIoRingFn)(void*, UINT32, UINT32, UINT32*);
+typedef HRESULT (WINAPI *PopIoRingCompletionFn)(void*, RingCompletion*);
+typedef HRESULT (WINAPI *CloseIoRingFn)(void*);
+
+struct RingApi
+{
+    CreateIoRingFn create = nullptr;
+    BuildIoRingWriteFileFn buildWrite = nullptr;
+    SubmitIoRingFn submit = nullptr;
+    PopIoRingCompletionFn popCompletion = nullptr;
+    CloseIoRingFn close = nullptr;
+};
+
+static const RingApi& GetRingApi()
+{
+    static const RingApi api = []() {
+        RingApi result;
+        HMODULE kernelBase = GetModuleHandleW(L"kernelbase.dll");
+        if (kernelBase)
+        {
+            result.create = reinterpret_cast<CreateIoRingFn>(GetProcAddress(kernelBase, "CreateIoRing"));
+            result.buildWrite = reinterpret_cast<BuildIoRingWriteFileFn>(GetProcAddress(kernelBase, "BuildIoRingWriteFile"));
+            result.submit = reinterpret_cast<SubmitIoRingFn>(GetProcAddress(kernelBase, "SubmitIoRing"));
+            result.popCompletion = reinterpret_cast<PopIoRingCompletionFn>(GetProcAddress(kernelBase, "PopIoRingCompletion"));
+            result.close = reinterpret_cast<CloseIoRingFn>(GetProcAddress(kernelBase, "CloseIoRing"));
+        }
+        return result;
+    }();
+    return api;
+}
+
+bool IoRingBackend::IsSupported()
+{
+    const RingApi& api = GetRingApi();
+    return api.create && api.buildWrite && api.submit && api.popCompletion && api.close;
+}
+
+IoRingBackend::IoRingBackend(DirectoryCache& directories, const ExtractionOptions& options, size_t slotCount, size_t slotSize)
+    : m_directories(directories)
+    , m_fileOptions(options)
+    , m_blocks(slotCount, slotSize)
+{
+    // Slots are written as they are; buffering them again would only copy
+    m_fileOptions.writeBufferSize = 0;
+    m_fileOptions.unbufferedWriteThreshold = 0;
+
+    if (!IsSupported())
+    {
+        return;
+    }
+
+    // Every write in flight holds a slot, so the ring never needs more entries than slots
+    m_queueSize = static_cast<uint32_t>(std::min<size_t>(std::max<size_t>(slotCount, 1), RING_MAX_QUEUE));
+
+    RingCreateFlags flags = { 0, 0 };
+    HRESULT hr = GetRingApi().create(RING_VERSION_3, flags, m_queueSize, m_queueSize * 2, &m_ring);
+    if (FAILED(hr))
+    {
+        LOG_WARNING(L"CreateIoRing failed (0x" + std::to_wstring(static_cast<uint32_t>(hr)) + L")");
+        m_ring = nullptr;
+        return;
+    }
+
+    m_thread = std::thread([this]() { Run(); });
+}
+
+IoRingBackend::~IoRingBackend()
+{
+    Finish();
+
+    if (m_ring)
+    {
+        GetRingApi().close(m_ring);
+    }
+}
+
+uint32_t IoRingBackend::BeginFile(const std::wstring& relativePath, bool sparse, int64_t length)
+{
+    uint32_t fileId = m_nextFileId++;
+
+    Command command{ CommandType::Open, fileId };
+    command.path = relativePath;
+    command.sparse = sparse;
+    command.offset = length;
+    Enqueue(std::move(command));
+    return fileId;
+}
+
+void IoRingBackend::Write(uint32_t fileId, const void* data, size_t size, int64_t offset)
+{
+    // Same copy into ring slots as WritePipeline::Write; the slot is the
+    // write's buffer until its completion is reaped
+    const char* source = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        size_t chunk = std::min(size, m_blocks.GetSlotSize());
+        char* slot = m_blocks.Acquire();
+        memcpy(slot, source, chunk);
+
+        Command command{ CommandType::Write, fileId };
+        command.slot = slot;
+        command.size = chunk;
+        command.offset = offset;
+        Enqueue(std::move(command));
+
+        source += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+}
+
+void IoRingBackend::EndFile(uint32_t fileId, int64_t length)
+{
+    Command command{ CommandType::Close, fileId };
+    command.offset = length;
+    Enqueue(std::move(command));
+}
+
+void IoRingBackend::DiscardFile(uint32_t fileId)
+{
+    Command command{ CommandType::Close, fileId };
+    command.offset = -1;
+    command.discard = true;
+    Enqueue(std::move(command));
+}
+
+void IoRingBackend::Enqueue(Command command)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_commands.push_back(std::move(command));
+    }
+    m_ready.notify_one();
+}
+
+bool IoRingBackend::Finish()
+{
+    if (m_finished)
+    {
+        return !m_failed;
+    }
+    m_finished = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_ready.notify_one();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    return !m_failed;
+}
+
+void IoRingBackend::Run()
+{
+    std::deque<Command> batch;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // With writes in flight the completions need reaping, so don't sleep on the queue
+            if (m_inFlight.empty())
+            {
+                m_ready.wait(lock, [this]() { return !m_commands.empty() || m_stopping; });
+            }
+            if (m_commands.empty() && m_stopping && m_inFlight.empty())
+            {
+                break; // Stopping and fully drained
+            }
+            batch.swap(m_commands);
+        }
+
+        for (Command& command : batch)
+        {
+            try
+            {
+                Execute(command);
+            }
+            catch (const std::exception& e)
+            {
+                std::string what = e.what();
+                Fail(std::wstring(what.begin(), what.end()));
+                if (command.slot && !m_inFlight.count(command.slot))
+                {
+                    m_blocks.Release(command.slot);
+                }
+            }
+        }
+
+        // One system call for everything queued above; only wait when the
+        // decoder has nothing new for us
+        bool idle = batch.empty();
+        batch.clear();
+        Submit(idle && !m_inFlight.empty() ? 1 : 0);
+        ReapCompletions();
+    }
+
+    // Files never closed (the decoder stopped early) are closed as they are
+    m_files.clear();
+}
+
+void IoRingBackend::Execute(Command& command)
+{
+    switch (command.type)
+    {
+    case CommandType::Open:
+    {
+        RingFile file;
+        // Asynchronous handle: on a synchronous one the ring would perform
+        // each write inline, one at a time, inside SubmitIoRing
+        if (!m_directories.OpenOutputFile(command.path, command.sparse, command.offset, m_fileOptions, file.output, true))
+        {
+            if (GetLastError() == ERROR_DISK_FULL)
+            {
+                Fail(L"Not enough disk space for " + m_directories.GetRoot() + L"\\" + command.path);
+                break;
+            }
+            LOG_ERROR(L"Failed to create file: " + m_directories.GetRoot() + L"\\" + command.path);
+            break; // Later writes for this file are dropped
+        }
+        m_files.emplace(command.fileId, std::move(file));
+        break;
+    }
+    case CommandType::Write:
+    {
+        // Make room: the completion queue must hold every write in flight
+        while (m_inFlight.size() >= m_queueSize)
+        {
+            Submit(1);
+            ReapCompletions();
+        }
+
+        auto it = m_files.find(command.fileId);
+        if (it == m_files.end() || m_failed)
+        {
+            m_blocks.Release(command.slot);
+            break;
+        }
+
+        RingHandleRef fileRef = {};
+        fileRef.kind = RING_REF_RAW;
+        fileRef.handle = it->second.output.GetHandle();
+        RingBufferRef bufferRef = {};
+        bufferRef.kind = RING_REF_RAW;
+        bufferRef.address = command.slot;
+
+        const RingApi& api = GetRingApi();
+        HRESULT hr = api.buildWrite(m_ring, fileRef, bufferRef, static_cast<UINT32>(command.size),
+                                    static_cast<UINT64>(command.offset), 0, reinterpret_cast<UINT_PTR>(command.slot), 0);
+        if (hr == RING_E_SUBMISSION_QUEUE_FULL)
+        {
+            Submit(0);
+            hr = api.buildWrite(m_ring, fileRef, bufferRef, static_cast<UINT32>(command.size),
+                                static_cast<UINT64>(command.offset), 0, reinterpret_cast<UINT_PTR>(command.slot), 0);
+        }
+        if (FAILED(hr))
+        {
+            Fail(L"Failed to queue extracted data (0x" + std::to_wstring(static_cast<uint32_t>(hr)) + L")");
+            m_blocks.Release(command.slot);
+            break;
+        }
+
+        m_inFlight.emplace(command.slot, command.fileId);
+        m_unsubmitted.push_back(command.slot);
+        it->second.pending++;
+        break;
+    }
+    case CommandType::Close:
+    {
+        auto it = m_files.find(command.fileId);
+        if (it != m_files.end())
+        {
+            it->second.closing = true;
+            it->second.discard = command.discard;
+            it->second.length = command.offset;
+            if (it->second.pending == 0)
+            {
+                CloseFile(command.fileId, it->second);
+            }
+        }
+        break;
+    }
+    }
+}
+
+void IoRingBackend::Submit(uint32_t waitCount)
+{
+    if (m_submitFailed)
+    {
+        // Only writes the kernel already accepted are left; their completions
+        // still arrive, so poll for them instead of submitting
+        if (waitCount > 0 && !m_inFlight.empty())
+        {
+            Sleep(1);
+        }
+        return;
+    }
+
+    UINT32 submitted = 0;
+    HRESULT hr = GetRingApi().submit(m_ring, waitCount, RING_WAIT_MS, &submitted);
+
+    // Entries leave the submission queue in the order they were built
+    for (UINT32 i = 0; i < submitted && !m_unsubmitted.empty(); i++)
+    {
+        m_unsubmitted.pop_front();
+    }
+
+    if (FAILED(hr) && hr != HRESULT_FROM_WIN32(WAIT_TIMEOUT))
+    {
+        Fail(L"Failed to submit extracted data (0x" + std::to_wstring(static_cast<uint32_t>(hr)) + L")");
+
+        // Nothing is submitted from now on, so only the writes still queued
+        // can give their slots back. Accepted writes keep their slot and file
+        // open until their completion is reaped.
+        m_submitFailed = true;
+        for (char* slot : m_unsubmitted)
+        {
+            RetireWrite(slot);
+        }
+        m_unsubmitted.clear();
+    }
+}
+
+void IoRingBackend::ReapCompletions()
+{
+    RingCompletion completion;
+    while (GetRingApi().popCompletion(m_ring, &completion) == S_OK)
+    {
+        if (FAILED(completion.result))
+        {
+            Fail(L"Failed to write extracted data (0x" + std::to_wstring(static_cast<uint32_t>(completion.result)) + L")");
+        }
+        RetireWrite(reinterpret_cast<char*>(completion.userData));
+    }
+}
+
+void IoRingBackend::RetireWrite(char* slot)
+{
+    auto inFlight = m_inFlight.find(slot);
+    if (inFlight == m_inFlight.end())
+    {
+        return;
+    }
+    uint32_t fileId = inFlight->second;
+    m_inFlight.erase(inFlight);
+    m_blocks.Release(slot);
+
+    auto it = m_files.find(fileId);
+    if (it != m_files.end() && --it->second.pending == 0 && it->second.closing)
+    {
+        CloseFile(fileId, it->second);
+    }
+}
+
+void IoRingBackend::CloseFile(uint32_t fileId, RingFile& file)
+{
+    // Only once its last write completed: the handle is no longer in use by the ring
+    if (file.discard)
+    {
+        file.output.Discard();
+    }
+    else if (file.length >= 0 && !file.output.SetLength(static_cast<uint64_t>(file.length)))
+    {
+        Fail(L"Failed to set extracted file size (disk full?)");
+    }
+    m_files.erase(fileId);
+}
+
+void IoRingBackend::Fail(const std::wstring& message)
+{
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    if (!m_failed.exchange(true))
+    {
+        m_error = message;
+        LOG_ERROR(L"I/O ring error: " + message);
+    }
+}
+
+std::wstring IoRingBackend::GetError()
+{
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    return m_error;
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,121 @@
+#pragma once
+#include "IOutputBackend.h"
+#include "OutputFile.h"
+#include "WritePipeline.h"
+#include "../Core/ExtractionOptions.h"
+#include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace ZipSpark {
+
+class DirectoryCache;
+
+/// <summary>
+/// Output backend on a Windows I/O ring (ioringapi, Windows 11 22H2 and later),
+/// the Windows counterpart of io_uring. One submission thread opens the files
+/// and queues their writes on the ring; each batch of queued writes costs a
+/// single system call, up to the ring size stay in flight, and a file is sized
+/// and closed as soon as its last write completes. The ring API is resolved at
+/// run time, so systems without it fall back to the writer threads.
+/// </summary>
+class IoRingBackend : public IOutputBackend
+{
+public:
+    // Whether this system exports the I/O ring API with file writes
+    static bool IsSupported();
+
+    IoRingBackend(DirectoryCache& directories, const ExtractionOptions& options, size_t slotCount, size_t slotSize);
+    ~IoRingBackend();
+
+    // False if the ring could not be created (use another backend)
+    bool IsReady() const { return m_ring != nullptr; }
+
+    uint32_t BeginFile(const std::wstring& relativePath, bool sparse = false, int64_t length = -1) override;
+    void Write(uint32_t fileId, const void* data, size_t size, int64_t offset) override;
+    void EndFile(uint32_t fileId, int64_t length = -1) override;
+    void DiscardFile(uint32_t fileId) override;
+
+    // Drain all queued work and stop the submission thread. Returns false if any write failed.
+    bool Finish() override;
+
+    bool HasFailed() const override { return m_failed; }
+    std::wstring GetError() override;
+    std::wstring GetBackendName() const override { return L"I/O ring"; }
+
+private:
+    IoRingBackend(const IoRingBackend&) = delete;
+    IoRingBackend& operator=(const IoRingBackend&) = delete;
+
+    enum class CommandType
+    {
+        Open,
+        Write,
+        Close
+    };
+
+    struct Command
+    {
+        CommandType type;
+        uint32_t fileId;
+        std::wstring path;           // Open only
+        bool sparse = false;         // Open only
+        bool discard = false;        // Close only: delete instead of keeping
+        char* slot = nullptr;        // Write only
+        size_t size = 0;
+        int64_t offset = 0;          // Write: file offset; Open/Close: final length or -1
+    };
+
+    struct RingFile
+    {
+        OutputFile output;           // Opened and preallocated like any entry; written through the ring
+        uint32_t pending = 0;        // Writes in flight
+        bool closing = false;
+        bool discard = false;
+        int64_t length = -1;
+    };
+
+    void Enqueue(Command command);
+    void Run();
+    void Execute(Command& command);
+
+    // Submit queued writes; waitCount > 0 also waits (briefly) for completions
+    void Submit(uint32_t waitCount);
+    void ReapCompletions();
+    // Release the slot of a write that completed or will never be submitted
+    void RetireWrite(char* slot);
+    void CloseFile(uint32_t fileId, RingFile& file);
+    void Fail(const std::wstring& message);
+
+    DirectoryCache& m_directories;
+    ExtractionOptions m_fileOptions;  // Ring writes are neither gathered nor unbuffered
+    BlockRing m_blocks;
+    void* m_ring = nullptr;           // HIORING
+    uint32_t m_queueSize = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::deque<Command> m_commands;
+    bool m_stopping = false;
+    std::thread m_thread;
+    uint32_t m_nextFileId = 0;
+    bool m_finished = false;
+
+    // Submission thread only
+    std::unordered_map<uint32_t, RingFile> m_files;
+    std::unordered_map<char*, uint32_t> m_inFlight;  // Slot -> file id
+    std::deque<char*> m_unsubmitted;                 // Queued on the ring, not yet submitted, in order
+    bool m_submitFailed = false;
+
+    std::atomic<bool> m_failed{ false };
+    std::mutex m_errorMutex;
+    std::wstring m_error;
+};
+
+} // namespace ZipSpark
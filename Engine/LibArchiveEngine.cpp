@@ -2,8 +2,24 @@
 #include "LibArchiveEngine.h"
 #include "../Utils/Logger.h"
 #include "../Utils/ErrorHandler.h"
+#include "../Utils/EventLog.h"
+#include "../Utils/PathValidator.h"
+#include "../Utils/Utf8.h"
+#include "ArchiveScanner.h"
+#include "ArchiveSource.h"
+#include "DestinationSnapshot.h"
+#include "DirectoryCache.h"
+#include "EntrySelector.h"
+#include "MemoryFileTable.h"
+#include "MetadataPass.h"
+#include "ExtractionScheduler.h"
+#include "OutputBackendFactory.h"
+#include "OutputFile.h"
+#include "ProgressAggregator.h"
+#include <cctype>
+#include <cwchar>
 #include <filesystem>
-#include <fstream>
+#include <thread>
 #include <archive.h>
 #include <archive_entry.h>
 
@@ -11,6 +27,191 @@ namespace fs = std::filesystem;
 
 namespace ZipSpark {
 
+/// <summary>
+/// State shared by every thread working on one extraction
+/// </summary>
+struct LibArchiveEngine::ExtractionJob
+{
+    ExtractionJob(const ArchiveInfo& info, const ExtractionOptions& options, IProgressCallback* callback,
+                  const fs::path& destPath, std::shared_ptr<ArchiveSource> source)
+        : info(info), options(options), callback(callback), destPath(destPath), source(std::move(source)), pathValidator(destPath),
+          directories(pathValidator.GetRoot()), selector(options.selection),
+          progress(callback, info.totalSize, static_cast<int>(info.fileCount))
+    {
+    }
+
+    const ArchiveInfo& info;
+    const ExtractionOptions& options;
+    IProgressCallback* callback;
+    fs::path destPath;
+
+    // Archive input shared by every reader of this job
+    std::shared_ptr<ArchiveSource> source;
+
+    // Zip Slip guard, canonicalized once for the whole job
+    PathValidator pathValidator;
+
+    // Existing directories and open parent handles under the destination
+    DirectoryCache directories;
+
+    // Entries to extract (empty = all)
+    EntrySelector selector;
+    uint32_t selectedEntries = 0; // Known from the archive index, 0 = unknown
+
+    // Workers only bump counters; OnProgress/OnFileProgress come from its emitter
+    // thread, so IProgressCallback implementations need not be thread-safe
+    ProgressAggregator progress;
+
+    // Writer stage when decoding and writing are pipelined
+    IOutputBackend* pipeline = nullptr;
+
+    // In-memory sink (cacheToMemory); flushMemory batches it to disk
+    std::shared_ptr<MemoryFileTable> memory;
+    bool flushMemory = false;
+
+    // Timestamps and attributes, applied once everything is written
+    std::unique_ptr<MetadataPass> metadata;
+
+    // What already exists at the destination (null if nothing can conflict)
+    std::unique_ptr<DestinationSnapshot> existing;
+    OverwritePolicy overwritePolicy = OverwritePolicy::Overwrite;
+
+    // First error reported by a parallel worker
+    std::atomic<bool> failed{ false };
+    std::atomic<DWORD> crashCode{ 0 }; // Hard fault that stopped a worker, if any
+    std::mutex errorMutex;
+    std::wstring errorMessage;
+    ErrorCode errorCode = ErrorCode::ExtractionFailed;
+
+    // Id of this job in the binary event log
+    uint32_t eventJob = 0;
+
+    void Fail(const std::wstring& message, ErrorCode code = ErrorCode::ExtractionFailed)
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!failed.exchange(true))
+        {
+            errorMessage = message;
+            errorCode = code;
+        }
+    }
+};
+
+struct ArchiveReadDeleter
+{
+    void operator()(struct archive* ptr) const
+    {
+        if (ptr) archive_read_free(ptr);
+    }
+};
+using ArchiveReadPtr = std::unique_ptr<struct archive, ArchiveReadDeleter>;
+
+// Raw entry path as stored in the archive, for selection matching
+static const char* EntryPathUtf8(struct archive_entry* entry)
+{
+    const char* path = archive_entry_pathname_utf8(entry);
+    return path ? path : archive_entry_pathname(entry);
+}
+
+// libarchive's reason for the last failure on a reader
+static std::wstring ArchiveErrorText(struct archive* a)
+{
+    const char* error = archive_error_string(a);
+    return error ? Utf8::ToWide(error) : std::wstring(L"unknown error");
+}
+
+// How a read failure is reported. libarchive has no error codes for
+// encryption or for methods and features it lacks, only its messages; those
+// cases may still extract with 7-Zip (see WorkerProcessEngine), the rest is
+// damage.
+static ErrorCode ArchiveErrorCode(struct archive* a)
+{
+    const char* error = archive_error_string(a);
+    std::string text = error ? error : "";
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (text.find("encrypt") != std::string::npos || text.find("passphrase") != std::string::npos ||
+        text.find("decrypt") != std::string::npos)
+    {
+        return ErrorCode::PasswordRequired;
+    }
+    if (text.find("unsupported") != std::string::npos || text.find("not supported") != std::string::npos)
+    {
+        return ErrorCode::UnsupportedFormat;
+    }
+    return ErrorCode::ArchiveCorrupted;
+}
+
+// archive_read_next_header, with ARCHIVE_WARN folded into ARCHIVE_OK: the
+// header was read and the entry is usable (an attribute or a name that did
+// not convert cleanly), so it is logged and extracted. ARCHIVE_FAILED and
+// ARCHIVE_FATAL come back as they are.
+static int ReadNextHeader(struct archive* a, struct archive_entry** entry)
+{
+    int result = archive_read_next_header(a, entry);
+    if (result == ARCHIVE_WARN)
+    {
+        LOG_WARNING(L"Archive entry header read with a warning: " + ArchiveErrorText(a));
+        return ARCHIVE_OK;
+    }
+    return result;
+}
+
+static bool IsSelected(const EntrySelector& selector, struct archive_entry* entry)
+{
+    if (selector.IsEmpty())
+    {
+        return true;
+    }
+    const char* path = EntryPathUtf8(entry);
+    return path && selector.Matches(path);
+}
+
+// Queue the timestamps and read-only bit the options ask to keep
+static void RecordMetadata(MetadataPass& metadata, struct archive_entry* entry, const std::wstring& relativePath,
+                           const ExtractionOptions& options)
+{
+    int64_t modified = 0;
+    int64_t accessed = 0;
+    int64_t created = 0;
+    if (options.preserveTimestamps)
+    {
+        if (archive_entry_mtime_is_set(entry))
+            modified = MetadataPass::UnixToFileTime(archive_entry_mtime(entry), archive_entry_mtime_nsec(entry));
+        if (archive_entry_atime_is_set(entry))
+            accessed = MetadataPass::UnixToFileTime(archive_entry_atime(entry), archive_entry_atime_nsec(entry));
+        if (archive_entry_birthtime_is_set(entry))
+            created = MetadataPass::UnixToFileTime(archive_entry_birthtime(entry), archive_entry_birthtime_nsec(entry));
+    }
+
+    // No owner write bit: read-only (how libarchive maps the ZIP/7z attribute)
+    bool readOnly = options.preservePermissions && (archive_entry_mode(entry) & 0200) == 0;
+
+    if (modified != 0 || accessed != 0 || created != 0 || readOnly)
+    {
+        metadata.Record(relativePath, archive_entry_filetype(entry) == AE_IFDIR, modified, accessed, created, readOnly);
+    }
+}
+
+// Open a fresh reader on the archive; every parallel worker owns one
+static ArchiveReadPtr OpenArchiveReader(const ArchiveSource& source)
+{
+    ArchiveReadPtr a(archive_read_new());
+    if (!a)
+    {
+        return nullptr;
+    }
+
+    archive_read_support_filter_all(a.get());
+    archive_read_support_format_all(a.get());
+
+    if (source.OpenReader(a.get()) != ARCHIVE_OK)
+    {
+        return nullptr;
+    }
+    return a;
+}
+
 LibArchiveEngine::LibArchiveEngine()
 {
     LOG_INFO(L"LibArchiveEngine initialized");
@@ -32,7 +233,8 @@ bool LibArchiveEngine::CanHandle(const std::wstring& archivePath)
 bool LibArchiveEngine::IsSupportedFormat(const std::wstring& extension)
 {
     // Supported formats
-    return extension == L".7z" ||
+    return extension == L".zip" ||
+           extension == L".7z" ||
            extension == L".rar" ||
            extension == L".tar" ||
            extension == L".gz" ||
@@ -53,7 +255,9 @@ ArchiveInfo LibArchiveEngine::GetArchiveInfo(const std::wstring& archivePath)
         std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
         
         // Detect format
-        if (ext == L".7z")
+        if (ext == L".zip")
+            info.format = ArchiveFormat::ZIP;
+        else if (ext == L".7z")
             info.format = ArchiveFormat::SevenZ;
         else if (ext == L".rar")
             info.format = ArchiveFormat::RAR;
@@ -68,14 +272,22 @@ ArchiveInfo LibArchiveEngine::GetArchiveInfo(const std::wstring& archivePath)
         else if (ext == L".txz" || path.filename().wstring().find(L".tar.xz") != std::wstring::npos)
             info.format = ArchiveFormat::TAR_XZ;
         
-        if (fs::exists(path))
+        // Uncompressed totals, counts and root layout from the headers
+        if (!ArchiveScanner::Scan(archivePath, ArchiveScanner::Mode::Full, info))
         {
-            info.totalSize = fs::file_size(path);
+            // Not listable without decoding it, or unreadable: fall back to the
+            // file size and let extraction report any error. The subfolder
+            // decision only needs the first entries.
+            if (fs::exists(path))
+            {
+                info.totalSize = fs::file_size(path);
+            }
+            info.fileCount = 0;
+            if (!ArchiveScanner::Scan(archivePath, ArchiveScanner::Mode::Quick, info))
+            {
+                info.hasSingleRoot = false;
+            }
         }
-        
-        // For now, assume multiple roots (will be refined with actual libarchive integration)
-        info.hasSingleRoot = false;
-        info.fileCount = 0; // Unknown until we scan with libarchive
     }
     catch (const std::exception& e)
     {
@@ -121,30 +333,36 @@ std::wstring LibArchiveEngine::DetermineDestination(const ArchiveInfo& info, con
     }
 }
 
-// Helper to sanitize filenames (remove invalid chars < > : " / \ | ? *)
-std::wstring SanitizePathComponent(const std::wstring& component)
+// Hard faults caught by the SEH wrappers. EXCEPTION_IN_PAGE_ERROR is what a
+// read from the mapped archive raises if the file shrinks or the volume goes away.
+static bool IsHardCrash(DWORD code)
 {
-    std::wstring sanitized = component;
-    const std::wstring invalidChars = L"<>:\"/\\|?*";
-    
-    for (auto& ch : sanitized)
+    return code == EXCEPTION_ACCESS_VIOLATION || code == EXCEPTION_IN_PAGE_ERROR;
+}
+
+// What the user is told about a hard fault, by exception code
+static std::wstring HardCrashMessage(DWORD code)
+{
+    wchar_t hex[16];
+    std::swprintf(hex, 16, L"0x%08X", static_cast<unsigned int>(code));
+
+    if (code == EXCEPTION_IN_PAGE_ERROR)
     {
-        if (invalidChars.find(ch) != std::wstring::npos || ch < 32)
-        {
-            ch = L'_';
-        }
+        return std::wstring(L"The archive's storage became unavailable (") + hex + L"). "
+               L"Check that the drive or network share is still connected.";
     }
-    return sanitized;
+    return std::wstring(L"System Memory Error (Access Violation, ") + hex + L"). "
+           L"The archive may be corrupt or incompatible.";
 }
 
 // Helper to log hard crashes (avoiding C2712 in Extract)
 void LogHardCrash(DWORD code, IProgressCallback* callback)
 {
-    std::wstring msg = L"CRITICAL ERROR: Access Violation (0x" + std::to_wstring(code) + L") caught in extraction engine.";
-    LOG_ERROR(msg);
+    std::wstring message = HardCrashMessage(code);
+    LOG_ERROR(L"CRITICAL ERROR caught in extraction engine: " + message);
     if (callback)
     {
-        callback->OnError(ErrorCode::ExtractionFailed, L"System Memory Error (Access Violation). The archive may be corrupt or incompatible.");
+        callback->OnError(ErrorCode::ExtractionFailed, message);
     }
 }
 
@@ -158,180 +376,279 @@ void LibArchiveEngine::Extract(const ArchiveInfo& info, const ExtractionOptions&
     {
         ExtractInternal(info, options, callback);
     }
-    __except (GetExceptionCode() == EXCEPTION_ACCESS_VIOLATION ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+    __except (IsHardCrash(GetExceptionCode()) ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
     {
         LogHardCrash(GetExceptionCode(), callback);
     }
 }
 
+uint32_t LibArchiveEngine::ResolveThreadCount(const ExtractionOptions& options) const
+{
+    if (options.threadCount > 0)
+    {
+        return options.threadCount;
+    }
+
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 0 ? hardwareThreads : 1;
+}
+
+bool LibArchiveEngine::ScanEntrySizes(const ArchiveSource& source, const EntrySelector& selector, std::vector<uint64_t>& entrySizes)
+{
+    entrySizes.clear();
+
+    ArchiveReadPtr a = OpenArchiveReader(source);
+    if (!a)
+    {
+        return false;
+    }
+
+    struct archive_entry* entry;
+    bool checkedLayout = false;
+    int result;
+
+    while ((result = ReadNextHeader(a.get(), &entry)) == ARCHIVE_OK && !m_cancelled)
+    {
+        // Format and filters are only known once the first header is read.
+        // Workers each re-read the archive from the start, which only pays off
+        // when skipping an entry is a seek rather than a decode: ZIP, or an
+        // uncompressed TAR. Solid 7z and compressed tarballs stay sequential.
+        if (!checkedLayout)
+        {
+            int format = archive_format(a.get()) & ARCHIVE_FORMAT_BASE_MASK;
+            bool isZip = format == ARCHIVE_FORMAT_ZIP;
+            bool isPlainTar = format == ARCHIVE_FORMAT_TAR &&
+                              archive_filter_code(a.get(), 0) == ARCHIVE_FILTER_NONE;
+            if (!isZip && !isPlainTar)
+            {
+                return false;
+            }
+            checkedLayout = true;
+        }
+
+        // Unselected entries are skipped by the workers and weigh nothing
+        bool counted = archive_entry_size_is_set(entry) && IsSelected(selector, entry);
+        entrySizes.push_back(counted ? static_cast<uint64_t>(archive_entry_size(entry)) : 0);
+        archive_read_data_skip(a.get());
+    }
+
+    // Sizes up to a damaged header would hand out tasks for only part of the
+    // archive; the sequential pass then reports the damage
+    if (result != ARCHIVE_EOF && !m_cancelled)
+    {
+        LOG_WARNING(L"Entry size scan stopped after " + std::to_wstring(entrySizes.size()) + L" entries: " +
+                    ArchiveErrorText(a.get()));
+        return false;
+    }
+    return checkedLayout && !m_cancelled;
+}
+
 void LibArchiveEngine::ExtractInternal(const ArchiveInfo& info, const ExtractionOptions& options, IProgressCallback* callback)
 {
     try
     {
         LOG_INFO(L"Starting extraction with libarchive: " + info.archivePath);
-        
+
         // Determine destination
         std::wstring destination = DetermineDestination(info, options);
-        
+        bool memoryOnly = options.cacheToMemory && options.memoryTarget;
+
         // Create destination directory if needed
         fs::path destPath(destination);
-        if (!fs::exists(destPath))
+        if (!memoryOnly && !fs::exists(destPath))
         {
             fs::create_directories(destPath);
         }
-        
-        LOG_INFO(L"Extracting to: " + destination);
-        
-        // Open archive using RAII for automatic cleanup
-        struct archive* raw_a = archive_read_new();
-        auto archive_deleter = [](struct archive* ptr) { 
-            if (ptr) archive_read_free(ptr); 
-        };
-        std::unique_ptr<struct archive, decltype(archive_deleter)> a(raw_a, archive_deleter);
-
-        archive_read_support_filter_all(a.get());
-        archive_read_support_format_all(a.get());
-        
-        // Use native wide-char API for Windows
-        int r = archive_read_open_filename_w(a.get(), info.archivePath.c_str(), 10240);
-        if (r != ARCHIVE_OK)
+
+        LOG_INFO(memoryOnly ? std::wstring(L"Extracting to memory") : L"Extracting to: " + destination);
+
+        // Map (or open) the archive once; all readers below share it
+        ExtractionJob job(info, options, callback, destPath, ArchiveSource::Open(info.archivePath, options));
+        job.eventJob = EventLog::GetInstance().NewJobId();
+        EventLog::Record(EventLog::EventId::JobStarted, job.eventJob, EventLog::GetInstance().AddString(info.archivePath),
+                         static_cast<uint64_t>(info.fileCount));
+
+        // The in-memory sink is filled by a single sequential pass
+        if (options.cacheToMemory)
         {
-            if (callback) callback->OnError(ErrorCode::ArchiveNotFound, L"Failed to open archive");
-            return;
+            job.memory = memoryOnly ? options.memoryTarget : std::make_shared<MemoryFileTable>(options.memoryBudget);
+            job.flushMemory = !memoryOnly;
         }
-        
-        if (callback) callback->OnStart(info.fileCount);
-        
-        // Extract files
-        struct archive_entry *entry;
-        int fileIndex = 0;
-        uint64_t totalExtracted = 0;
-        
-        while (archive_read_next_header(a.get(), &entry) == ARCHIVE_OK && !m_cancelled)
+
+        if (!memoryOnly && (options.preserveTimestamps || options.preservePermissions))
+        {
+            job.metadata = std::make_unique<MetadataPass>(job.pathValidator.GetRoot());
+        }
+
+        // Directory listings instead of a stat per entry, only of directories
+        // the archive writes to; a fresh destination (or plain overwriting) needs none
+        if (!memoryOnly && options.overwritePolicy != OverwritePolicy::Overwrite)
         {
-            // Get entry path and convert to wide string
-            const char* entryPath = archive_entry_pathname(entry);
-            std::wstring entryPathW;
-            
-            if (entryPath)
+            auto existing = std::make_unique<DestinationSnapshot>(job.pathValidator.GetRoot());
+            if (!existing->IsEmpty())
             {
-                int wsize = MultiByteToWideChar(CP_UTF8, 0, entryPath, -1, nullptr, 0);
-                if (wsize > 0)
+                job.overwritePolicy = existing->ResolvePolicy(options.overwritePolicy, info, job.selector, job.pathValidator, callback);
+                if (job.overwritePolicy != OverwritePolicy::Overwrite)
                 {
-                    entryPathW.resize(wsize);
-                    MultiByteToWideChar(CP_UTF8, 0, entryPath, -1, &entryPathW[0], wsize);
-                    entryPathW.resize(wsize - 1); // Exclude null terminator
+                    job.existing = std::move(existing);
                 }
             }
-            else
+        }
+
+        // Decide between parallel per-entry extraction and a single sequential pass
+        uint32_t threadCount = ResolveThreadCount(options);
+        std::vector<uint64_t> entrySizes;
+        std::unique_ptr<ExtractionScheduler> scheduler;
+
+        // A selection narrows the totals; the index (when the scan built one) has the sizes
+        if (!job.selector.IsEmpty() && info.index)
+        {
+            uint64_t selectedBytes = 0;
+            uint32_t selectedEntries = 0;
+            for (size_t i = 0; i < info.index->GetEntryCount(); i++)
             {
-                LOG_ERROR(L"Skipping entry with null path");
-                continue;
+                const ArchiveIndexEntry& entry = info.index->GetEntry(i);
+                if (job.selector.Matches(info.index->GetName(entry)))
+                {
+                    selectedBytes += entry.size;
+                    selectedEntries++;
+                }
             }
-            
-            LOG_INFO(L"Processing entry: " + entryPathW); // Trace logging
-            
-            // SECURITY CHECK: Prevent Zip Slip (Directory Traversal)
-            // Sanitize path components to prevent invalid chars
-            fs::path entryPathObj(entryPathW);
-            fs::path sanitizedEntryPath;
-            
-            for (const auto& component : entryPathObj)
+            job.selectedEntries = selectedEntries;
+            job.progress.SetTotals(selectedBytes, static_cast<int>(selectedEntries));
+            LOG_INFO(L"Selective extraction: " + std::to_wstring(selectedEntries) + L" of " +
+                     std::to_wstring(info.index->GetEntryCount()) + L" entries");
+        }
+
+        if (threadCount > 1 && !job.memory && ScanEntrySizes(*job.source, job.selector, entrySizes) && entrySizes.size() > 1)
+        {
+            auto tasks = ExtractionScheduler::BuildTasks(entrySizes, threadCount);
+            uint32_t workerCount = std::min<uint32_t>(threadCount, static_cast<uint32_t>(tasks.size()));
+            if (workerCount > 1)
             {
-                 // Don't sanitize separators (handled by fs::path iteration)
-                 // But do sanitize component names
-                 sanitizedEntryPath /= SanitizePathComponent(component.wstring());
+                scheduler = std::make_unique<ExtractionScheduler>(std::move(tasks), workerCount);
             }
+        }
 
-            // 1. Force relative path
-            if (sanitizedEntryPath.is_absolute())
+        if (m_cancelled)
+        {
+            LOG_INFO(L"Extraction cancelled");
+            return;
+        }
+
+        // The scan knows the unpacked size: refuse up front rather than
+        // filling the disk and failing halfway through
+        if (!entrySizes.empty())
+        {
+            uint64_t requiredBytes = 0;
+            for (uint64_t size : entrySizes)
             {
-                sanitizedEntryPath = sanitizedEntryPath.relative_path();
+                requiredBytes += size;
             }
-            
-            // 2. Build full potential path
-            fs::path fullPath = destPath / sanitizedEntryPath;
-            
-            // 3. Verify it is still inside destPath
-            try 
+
+            ULARGE_INTEGER freeBytes;
+            if (GetDiskFreeSpaceExW(destination.c_str(), &freeBytes, nullptr, nullptr) &&
+                freeBytes.QuadPart < requiredBytes)
             {
-                fs::path canonicalDest = fs::weakly_canonical(destPath);
-                fs::path canonicalFull = fs::weakly_canonical(fullPath);
-                
-                std::wstring sDest = canonicalDest.wstring();
-                std::wstring sFull = canonicalFull.wstring();
-                
-                // Ensure sFull starts with sDest
-                if (sFull.length() < sDest.length() || 
-                    sFull.compare(0, sDest.length(), sDest) != 0)
-                {
-                    LOG_ERROR(L"Security Warning: Skipped file with invalid path (outside destination): " + entryPathW);
-                    continue;
-                }
+                std::wstring message = L"Not enough disk space: " + std::to_wstring(requiredBytes / (1024 * 1024)) +
+                                       L" MB needed, " + std::to_wstring(freeBytes.QuadPart / (1024 * 1024)) + L" MB free";
+                LOG_ERROR(message);
+                if (callback) callback->OnError(ErrorCode::InsufficientSpace, message);
+                return;
             }
-            catch (...)
+        }
+
+        if (scheduler)
+        {
+            LOG_INFO(L"Parallel extraction: " + std::to_wstring(entrySizes.size()) + L" entries on " +
+                     std::to_wstring(scheduler->GetWorkerCount()) + L" workers");
+
+            if (callback) callback->OnStart(info.fileCount);
+            job.progress.Start();
+            ExtractParallel(*scheduler, job);
+        }
+        else
+        {
+            // Open archive using RAII for automatic cleanup
+            ArchiveReadPtr a = OpenArchiveReader(*job.source);
+            if (!a)
             {
-                LOG_ERROR(L"Error validating path: " + entryPathW);
-                continue;
+                // The scan found the file, so libarchive can't read this format
+                if (callback) callback->OnError(ErrorCode::UnsupportedFormat, L"Failed to open archive");
+                return;
             }
-            
-            // Report file progress
-            if (callback)
+
+            if (callback) callback->OnStart(info.fileCount);
+            job.progress.Start();
+
+            if (threadCount > 1 && !job.memory)
             {
-                callback->OnFileProgress(entryPathW, fileIndex, info.fileCount);
+                // Entries can't be decoded in parallel here, but disk writes can
+                // overlap decoding: this thread decodes, the pipeline writes
+                size_t slotSize = std::max<size_t>(options.bufferSize, 4096);
+                size_t slotCount = std::max<size_t>(static_cast<size_t>(options.pipelineMemoryLimit / slotSize), 4);
+                uint32_t writerCount = std::min<uint32_t>(threadCount - 1, 4);
+
+                std::unique_ptr<IOutputBackend> pipeline =
+                    OutputBackendFactory::CreateBackend(job.directories, options, writerCount, slotCount, slotSize);
+
+                LOG_INFO(L"Pipelined extraction (" + pipeline->GetBackendName() + L"): " + std::to_wstring(slotCount) +
+                         L" x " + std::to_wstring(slotSize) + L" byte blocks");
+
+                job.pipeline = pipeline.get();
+                ExtractSequential(a.get(), job);
+                job.pipeline = nullptr;
+
+                if (!pipeline->Finish())
+                {
+                    job.Fail(pipeline->GetError());
+                }
             }
-            
-            // Create directories
-            if (archive_entry_filetype(entry) == AE_IFDIR)
+            else
             {
-                fs::create_directories(fullPath);
+                ExtractSequential(a.get(), job);
             }
-            else
+
+            // Write out the last batch of the in-memory sink
+            if (job.flushMemory && !m_cancelled && !job.failed)
             {
-                // Create parent directory
-                fs::create_directories(fullPath.parent_path());
-                
-                // Extract file
-                std::ofstream outFile(fullPath, std::ios::binary);
-                if (!outFile)
+                std::wstring error;
+                if (!job.memory->Flush(job.directories, options, error))
                 {
-                    LOG_ERROR(L"Failed to create file: " + fullPath.wstring());
-                    continue;
+                    job.Fail(error, GetLastError() == ERROR_DISK_FULL ? ErrorCode::InsufficientSpace : ErrorCode::ExtractionFailed);
                 }
-                
-                const void* buff;
-                size_t blockSize;
-                int64_t offset;
-                
-                while (archive_read_data_block(a.get(), &buff, &blockSize, &offset) == ARCHIVE_OK)
-                {
-                    outFile.write(static_cast<const char*>(buff), blockSize);
-                    totalExtracted += blockSize;
-                    
-                    // Update progress
-                    int progress = info.totalSize > 0 ? 
-                        static_cast<int>((totalExtracted * 100) / info.totalSize) : 0;
-                    
-                    if (callback)
-                    {
-                        callback->OnProgress(progress, totalExtracted, info.totalSize);
-                    }
-                }
-                
-                outFile.close();
             }
-            
-            fileIndex++;
+
+            // archive_read_free is called automatically by unique_ptr
         }
-        
-        // archive_read_free is called automatically by unique_ptr
-        
+
+        // Metadata last: later writes would otherwise bump directory times
+        if (job.metadata && !m_cancelled && !job.failed)
+        {
+            job.metadata->Apply(threadCount);
+        }
+
+        // Last snapshot goes out before the final callbacks
+        job.progress.Stop();
+
+        ErrorCode result = m_cancelled ? ErrorCode::CancellationRequested : job.failed ? job.errorCode : ErrorCode::Success;
+        EventLog::Record(EventLog::EventId::JobFinished, job.eventJob, static_cast<uint64_t>(result), job.progress.GetBytes());
+        EventLog::GetInstance().FlushThread();
+
         if (m_cancelled)
         {
             LOG_INFO(L"Extraction cancelled");
             return;
         }
-        
+
+        if (job.failed)
+        {
+            std::wstring message = job.errorMessage.empty() ? HardCrashMessage(job.crashCode) : job.errorMessage;
+            LOG_ERROR(L"Extraction failed: " + message);
+            if (callback) callback->OnError(job.errorCode, message);
+            return;
+        }
+
         if (callback)
         {
             callback->OnProgress(100, info.totalSize, info.totalSize);
@@ -351,6 +668,390 @@ void LibArchiveEngine::ExtractInternal(const ArchiveInfo& info, const Extraction
         if (callback) callback->OnError(ErrorCode::ExtractionFailed, L"Unknown Error");
     }
 }
+
+void LibArchiveEngine::ExtractSequential(struct archive* a, ExtractionJob& job)
+{
+    struct archive_entry *entry;
+
+    uint32_t extracted = 0;
+
+    for (uint32_t index = 0; !m_cancelled; index++)
+    {
+        // Stop decoding once a write has failed (e.g. disk full)
+        if (job.failed || (job.pipeline && job.pipeline->HasFailed()))
+        {
+            break;
+        }
+
+        // A header that can't be read ends the pass as a failure: the
+        // entries after it would silently be missing
+        int result = ReadNextHeader(a, &entry);
+        if (result == ARCHIVE_EOF)
+        {
+            break;
+        }
+        if (result != ARCHIVE_OK)
+        {
+            job.Fail(L"Failed to read archive entry " + std::to_wstring(index) + L": " + ArchiveErrorText(a),
+                     ArchiveErrorCode(a));
+            break;
+        }
+
+        // Unselected bodies are skipped, not decoded: a seek for ZIP and for
+        // 7z folders holding no selected entry
+        if (!IsSelected(job.selector, entry))
+        {
+            archive_read_data_skip(a);
+            continue;
+        }
+
+        ExtractEntry(a, entry, job);
+
+        // Everything selected is out; don't read the rest of a stream
+        if (job.selectedEntries > 0 && ++extracted == job.selectedEntries)
+        {
+            break;
+        }
+    }
+}
+
+void LibArchiveEngine::ExtractParallel(ExtractionScheduler& scheduler, ExtractionJob& job)
+{
+    std::vector<std::thread> workers;
+    workers.reserve(scheduler.GetWorkerCount());
+
+    for (uint32_t i = 0; i < scheduler.GetWorkerCount(); i++)
+    {
+        workers.emplace_back([this, i, &scheduler, &job]() {
+            RunExtractionWorkerGuarded(i, scheduler, job);
+        });
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void LibArchiveEngine::RunExtractionWorkerGuarded(uint32_t workerIndex, ExtractionScheduler& scheduler, ExtractionJob& job)
+{
+    // Same SEH guard as Extract: the __try there does not cover worker threads
+    // NOTE: This function must NOT contain any objects with destructors (C2712)
+    __try
+    {
+        RunExtractionWorker(workerIndex, scheduler, job);
+    }
+    __except (IsHardCrash(GetExceptionCode()) ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+    {
+        LogHardCrash(GetExceptionCode(), nullptr);
+        job.crashCode = GetExceptionCode();
+        job.failed = true;
+    }
+}
+
+void LibArchiveEngine::RunExtractionWorker(uint32_t workerIndex, ExtractionScheduler& scheduler, ExtractionJob& job)
+{
+    try
+    {
+        ArchiveReadPtr a;
+        uint32_t cursor = 0; // Index of the entry the next archive_read_next_header returns
+        EntryTask task;
+
+        while (!m_cancelled && !job.failed && scheduler.Next(workerIndex, task))
+        {
+            // Stolen tasks can lie behind our reader; start over in that case
+            if (!a || task.firstEntry < cursor)
+            {
+                a = OpenArchiveReader(*job.source);
+                cursor = 0;
+                if (!a)
+                {
+                    job.Fail(L"Failed to open archive");
+                    return;
+                }
+            }
+
+            struct archive_entry* entry;
+            for (; cursor <= task.lastEntry && !m_cancelled; cursor++)
+            {
+                if (ReadNextHeader(a.get(), &entry) != ARCHIVE_OK)
+                {
+                    job.Fail(L"Failed to read archive entry " + std::to_wstring(cursor) + L": " + ArchiveErrorText(a.get()),
+                             ArchiveErrorCode(a.get()));
+                    return;
+                }
+
+                if (cursor < task.firstEntry || !IsSelected(job.selector, entry))
+                {
+                    archive_read_data_skip(a.get());
+                    continue;
+                }
+
+                ExtractEntry(a.get(), entry, job);
+            }
+        }
+
+        EventLog::GetInstance().FlushThread();
+    }
+    catch (const std::exception& e)
+    {
+        std::string what = e.what();
+        std::wstring wwhat(what.begin(), what.end());
+        LOG_ERROR(L"Exception in extraction worker " + std::to_wstring(workerIndex) + L": " + wwhat);
+        job.Fail(wwhat);
+    }
+    catch (...)
+    {
+        LOG_ERROR(L"Unknown exception in extraction worker " + std::to_wstring(workerIndex));
+        job.Fail(L"Unknown Error");
+    }
+}
+
+void LibArchiveEngine::ExtractEntry(struct archive* a, struct archive_entry* entry, ExtractionJob& job)
+{
+    // Get entry path and convert to wide string, in one pass into a buffer
+    // each thread reuses. Names that are not UTF-8 are legacy CP437 ZIP names.
+    const char* entryPath = EntryPathUtf8(entry);
+    if (!entryPath)
+    {
+        LOG_ERROR(L"Skipping entry with null path");
+        return;
+    }
+
+    thread_local std::wstring entryPathW;
+    Utf8::DecodeEntryName(entryPath, entryPathW);
+
+    LOG_DEBUGF(L"Processing entry: {}", entryPathW);
+
+    // SECURITY CHECK: Prevent Zip Slip (Directory Traversal)
+    // Purely lexical: rejects "..", absolute and drive-letter paths and
+    // sanitizes invalid characters without a filesystem round trip per entry.
+    // Links that already exist under the destination are refused when
+    // DirectoryCache opens each component.
+    std::wstring relativePath;
+    if (!job.pathValidator.Resolve(entryPathW, relativePath))
+    {
+        LOG_ERROR(L"Security Warning: Skipped file with invalid path (outside destination): " + entryPathW);
+        return;
+    }
+
+    // No passphrase is ever supplied, so the entry can't be decoded; failing
+    // before its file is created leaves nothing half-written
+    if (archive_entry_is_encrypted(entry))
+    {
+        job.Fail(L"Password required for " + entryPathW, ErrorCode::PasswordRequired);
+        return;
+    }
+
+    job.progress.AddFile(entryPathW);
+
+    // Existing files are found in the snapshot; directories are merged
+    if (job.existing && archive_entry_filetype(entry) != AE_IFDIR && job.existing->Contains(relativePath))
+    {
+        if (job.overwritePolicy == OverwritePolicy::Skip)
+        {
+            LOG_INFOF(L"Skipped existing file: {}", job.pathValidator.GetFullPath(relativePath));
+            EventLog::Record(EventLog::EventId::EntrySkipped, job.eventJob, EventLog::GetInstance().AddString(entryPath));
+            return;
+        }
+        relativePath = job.existing->ReserveUnique(relativePath);
+    }
+
+    if (job.metadata)
+    {
+        RecordMetadata(*job.metadata, entry, relativePath, job.options);
+    }
+
+    if (job.memory && ExtractEntryToMemory(a, entry, relativePath, job))
+    {
+        return;
+    }
+
+    // Directories are created relative to their cached parent handle;
+    // parallel workers racing on a shared parent both see it as existing
+    if (archive_entry_filetype(entry) == AE_IFDIR)
+    {
+        if (!job.directories.EnsureDirectory(relativePath))
+        {
+            LOG_ERROR(L"Failed to create directory: " + job.pathValidator.GetFullPath(relativePath));
+        }
+    }
+    else
+    {
+        const void* buff;
+        size_t blockSize;
+        int64_t offset;
+
+        // Blocks are written at the offset libarchive reports. For sparse
+        // tar/pax entries the data blocks skip over the holes, which then stay
+        // unallocated; the final size covers a trailing hole.
+        bool sparse = archive_entry_sparse_count(entry) > 0;
+        int64_t length = archive_entry_size_is_set(entry) ? archive_entry_size(entry) : -1;
+
+        // Archive name of the entry in the event log (0 when it is off)
+        uint32_t eventPath = EventLog::GetInstance().AddString(entryPath);
+
+        // Pipelined: copy blocks to the writer stage and keep decoding
+        if (job.pipeline)
+        {
+            uint32_t fileId = job.pipeline->BeginFile(relativePath, sparse, length);
+            EventLog::Record(EventLog::EventId::FileOpened, job.eventJob, eventPath, static_cast<uint64_t>(length));
+            int result;
+            while ((result = archive_read_data_block(a, &buff, &blockSize, &offset)) == ARCHIVE_OK)
+            {
+                EventLog::Record(EventLog::EventId::BlockDecoded, job.eventJob, static_cast<uint64_t>(offset), blockSize);
+                job.pipeline->Write(fileId, buff, blockSize, offset);
+                job.progress.AddBytes(blockSize);
+            }
+            if (result != ARCHIVE_EOF)
+            {
+                // Sizing it to length would pass the damage off as a whole file
+                job.pipeline->DiscardFile(fileId);
+                EventLog::Record(EventLog::EventId::EntryFailed, job.eventJob, eventPath, ERROR_INVALID_DATA);
+                job.Fail(L"Failed to read " + job.pathValidator.GetFullPath(relativePath) + L": " + ArchiveErrorText(a),
+                         ArchiveErrorCode(a));
+                return;
+            }
+            job.pipeline->EndFile(fileId, length);
+            EventLog::Record(EventLog::EventId::FileClosed, job.eventJob, eventPath, static_cast<uint64_t>(length));
+            return;
+        }
+
+        // Extract file (parent directories are created on demand). The final
+        // size is preallocated, so a full disk fails here before any decoding.
+        OutputFile outFile;
+        if (!job.directories.OpenOutputFile(relativePath, sparse, length, job.options, outFile))
+        {
+            DWORD error = GetLastError();
+            EventLog::Record(EventLog::EventId::EntryFailed, job.eventJob, eventPath, error);
+            if (error == ERROR_DISK_FULL)
+            {
+                job.Fail(L"Not enough disk space for " + job.pathValidator.GetFullPath(relativePath),
+                         ErrorCode::InsufficientSpace);
+                return;
+            }
+            LOG_ERROR(L"Failed to create file: " + job.pathValidator.GetFullPath(relativePath));
+            return;
+        }
+
+        EventLog::Record(EventLog::EventId::FileOpened, job.eventJob, eventPath, static_cast<uint64_t>(length));
+        uint64_t written = 0;
+        int result;
+        while ((result = archive_read_data_block(a, &buff, &blockSize, &offset)) == ARCHIVE_OK)
+        {
+            EventLog::Record(EventLog::EventId::BlockDecoded, job.eventJob, static_cast<uint64_t>(offset), blockSize);
+            if (!outFile.WriteAt(buff, blockSize, offset))
+            {
+                DWORD error = GetLastError();
+                EventLog::Record(EventLog::EventId::EntryFailed, job.eventJob, eventPath, error);
+                job.Fail(L"Failed to write file: " + job.pathValidator.GetFullPath(relativePath) +
+                         L" (error " + std::to_wstring(error) + L")");
+                return;
+            }
+            job.progress.AddBytes(blockSize);
+            written = std::max<uint64_t>(written, static_cast<uint64_t>(offset) + blockSize);
+        }
+
+        if (result != ARCHIVE_EOF)
+        {
+            outFile.Discard();
+            EventLog::Record(EventLog::EventId::EntryFailed, job.eventJob, eventPath, ERROR_INVALID_DATA);
+            job.Fail(L"Failed to read " + job.pathValidator.GetFullPath(relativePath) + L": " + ArchiveErrorText(a),
+                     ArchiveErrorCode(a));
+            return;
+        }
+
+        bool finished = length >= 0 ? outFile.SetLength(static_cast<uint64_t>(length)) : outFile.Flush();
+        if (!finished)
+        {
+            DWORD error = GetLastError();
+            EventLog::Record(EventLog::EventId::EntryFailed, job.eventJob, eventPath, error);
+            job.Fail(L"Failed to write file: " + job.pathValidator.GetFullPath(relativePath) +
+                     L" (error " + std::to_wstring(error) + L")");
+            return;
+        }
+
+        outFile.Close();
+        EventLog::Record(EventLog::EventId::FileClosed, job.eventJob, eventPath,
+                         length >= 0 ? static_cast<uint64_t>(length) : written);
+    }
+}
+
+bool LibArchiveEngine::ExtractEntryToMemory(struct archive* a, struct archive_entry* entry, const std::wstring& relativePath,
+                                            ExtractionJob& job)
+{
+    if (archive_entry_filetype(entry) == AE_IFDIR)
+    {
+        job.memory->AddDirectory(relativePath);
+        return true;
+    }
+
+    int64_t length = archive_entry_size_is_set(entry) ? archive_entry_size(entry) : -1;
+
+    // Batching to disk: entries that could never share a batch (or whose size
+    // is unknown, so may not) are written directly
+    if (job.flushMemory && (length < 0 || static_cast<uint64_t>(length) > job.memory->GetBudget()))
+    {
+        return false;
+    }
+
+    MemoryFile* file = job.memory->AddFile(relativePath, length);
+    if (!file && job.flushMemory)
+    {
+        // Budget is full: write out this batch and start the next
+        std::wstring error;
+        if (!job.memory->Flush(job.directories, job.options, error))
+        {
+            job.Fail(error, GetLastError() == ERROR_DISK_FULL ? ErrorCode::InsufficientSpace : ErrorCode::ExtractionFailed);
+            return true;
+        }
+        file = job.memory->AddFile(relativePath, length);
+    }
+
+    if (!file)
+    {
+        job.Fail(L"Memory budget exceeded by " + relativePath, ErrorCode::InsufficientSpace);
+        return true;
+    }
+
+    const void* buff;
+    size_t blockSize;
+    int64_t offset;
+    int result;
+    while ((result = archive_read_data_block(a, &buff, &blockSize, &offset)) == ARCHIVE_OK)
+    {
+        if (!job.memory->Write(*file, buff, blockSize, offset))
+        {
+            job.Fail(L"Memory budget exceeded by " + relativePath, ErrorCode::InsufficientSpace);
+            return true;
+        }
+        job.progress.AddBytes(blockSize);
+    }
+
+    if (result != ARCHIVE_EOF)
+    {
+        job.Fail(L"Failed to read " + relativePath + L": " + ArchiveErrorText(a), ArchiveErrorCode(a));
+        return true;
+    }
+
+    // Trailing hole of a sparse entry
+    if (length > 0 && file->size < static_cast<uint64_t>(length))
+    {
+        if (!job.memory->Write(*file, nullptr, 0, length))
+        {
+            job.Fail(L"Memory budget exceeded by " + relativePath, ErrorCode::InsufficientSpace);
+        }
+    }
+    return true;
+}
+
+void LibArchiveEngine::CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>&, const std::wstring&, const CompressionProfile&, IProgressCallback* callback)
+{
+    // Read-only engine; archives are created through 7-Zip
+    LOG_ERROR(L"Archive creation is not supported by libarchive engine: " + destinationPath);
+    if (callback) callback->OnError(ErrorCode::UnsupportedFormat, L"Archive creation is not supported by this engine");
+}
+
 void LibArchiveEngine::Cancel()
 {
     m_cancelled = true;
@@ -3,12 +3,20 @@
 #include "../Core/ArchiveInfo.h"
 #include "../Core/ExtractionOptions.h"
 #include <atomic>
+#include <filesystem>
+
+struct archive;
+struct archive_entry;
 
 namespace ZipSpark {
 
+class ArchiveSource;
+class EntrySelector;
+class ExtractionScheduler;
+
 /// <summary>
 /// Extraction engine using libarchive for multi-format support
-/// Supports: 7z, RAR, TAR, GZ, XZ, TAR.GZ, TAR.XZ
+/// Supports: ZIP, 7z, RAR, TAR, GZ, XZ, TAR.GZ, TAR.XZ
 /// </summary>
 class LibArchiveEngine : public IExtractionEngine
 {
@@ -19,18 +27,34 @@ public:
     bool CanHandle(const std::wstring& archivePath) override;
     ArchiveInfo GetArchiveInfo(const std::wstring& archivePath) override;
     void Extract(const ArchiveInfo& info, const ExtractionOptions& options, IProgressCallback* callback) override;
-    
+    void CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>& sourceFiles, const std::wstring& format, const CompressionProfile& profile, IProgressCallback* callback) override;
+
 private:
+    // Shared state of one extraction job (defined in LibArchiveEngine.cpp)
+    struct ExtractionJob;
+
     void ExtractInternal(const ArchiveInfo& info, const ExtractionOptions& options, IProgressCallback* callback);
     void Cancel() override;
     std::wstring GetEngineName() const override { return L"libarchive"; }
 
+    // Extraction strategies
+    void ExtractSequential(struct archive* a, ExtractionJob& job);
+    void ExtractParallel(ExtractionScheduler& scheduler, ExtractionJob& job);
+    void RunExtractionWorkerGuarded(uint32_t workerIndex, ExtractionScheduler& scheduler, ExtractionJob& job);
+    void RunExtractionWorker(uint32_t workerIndex, ExtractionScheduler& scheduler, ExtractionJob& job);
+    void ExtractEntry(struct archive* a, struct archive_entry* entry, ExtractionJob& job);
+    // Decode an entry into job.memory; false if it should go to disk instead
+    bool ExtractEntryToMemory(struct archive* a, struct archive_entry* entry, const std::wstring& relativePath,
+                              ExtractionJob& job);
+
 private:
     std::atomic<bool> m_cancelled{false};
-    
+
     // Helper methods
     std::wstring DetermineDestination(const ArchiveInfo& info, const ExtractionOptions& options);
     bool IsSupportedFormat(const std::wstring& extension);
+    bool ScanEntrySizes(const ArchiveSource& source, const EntrySelector& selector, std::vector<uint64_t>& entrySizes);
+    uint32_t ResolveThreadCount(const ExtractionOptions& options) const;
 };
 
 } // namespace ZipSpark
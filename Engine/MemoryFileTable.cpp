@@ -0,0 +1,202 @@
+#include "pch.h"
+#include "MemoryFileTable.h"
+#include "DirectoryCache.h"
+#include "OutputFile.h"
+#include "../Utils/Logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ZipSpark {
+
+// Arena chunk size; entries above a quarter of it get a chunk of their own
+constexpr size_t ARENA_CHUNK_SIZE = 4 * 1024 * 1024; // 4 MB
+
+MemoryFileTable::MemoryFileTable(uint64_t budget)
+    : m_budget(budget)
+{
+}
+
+char* MemoryFileTable::Allocate(uint64_t size)
+{
+    if (size == 0)
+    {
+        return nullptr;
+    }
+
+    // Large entries: dedicated allocation, the current chunk stays open
+    if (size > ARENA_CHUNK_SIZE / 4)
+    {
+        if (m_used + size > m_budget)
+        {
+            return nullptr;
+        }
+        m_chunks.emplace_back(new char[static_cast<size_t>(size)]);
+        m_used += size;
+        return m_chunks.back().get();
+    }
+
+    if (m_chunkSize - m_chunkUsed < size)
+    {
+        // Near the end of the budget (or with one below a chunk), the next
+        // chunk is whatever is left of it
+        uint64_t remaining = m_budget > m_used ? m_budget - m_used : 0;
+        size_t chunkSize = static_cast<size_t>(std::min<uint64_t>(ARENA_CHUNK_SIZE, remaining));
+        if (chunkSize < size)
+        {
+            return nullptr;
+        }
+        m_chunks.emplace_back(new char[chunkSize]);
+        m_used += chunkSize;
+        m_chunk = m_chunks.back().get();
+        m_chunkSize = chunkSize;
+        m_chunkUsed = 0;
+    }
+
+    char* block = m_chunk + m_chunkUsed;
+    m_chunkUsed += static_cast<size_t>((size + 15) & ~static_cast<uint64_t>(15));
+    m_chunkUsed = std::min(m_chunkUsed, m_chunkSize);
+    return block;
+}
+
+MemoryFile* MemoryFileTable::AddFile(const std::wstring& relativePath, int64_t sizeHint)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    char* data = nullptr;
+    if (sizeHint > 0)
+    {
+        data = Allocate(static_cast<uint64_t>(sizeHint));
+        if (!data)
+        {
+            return nullptr;
+        }
+    }
+
+    m_files.emplace_back();
+    MemoryFile& file = m_files.back();
+    file.path = relativePath;
+    file.data = data;
+    file.capacity = sizeHint > 0 ? static_cast<uint64_t>(sizeHint) : 0;
+
+    m_byPath[relativePath] = &file;
+    return &file;
+}
+
+void MemoryFileTable::AddDirectory(const std::wstring& relativePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.emplace_back();
+    m_files.back().path = relativePath;
+    m_files.back().isDirectory = true;
+}
+
+bool MemoryFileTable::Write(MemoryFile& file, const void* data, size_t size, int64_t offset)
+{
+    uint64_t end = static_cast<uint64_t>(offset) + size;
+    if (end > file.capacity)
+    {
+        // Size unknown or wrong: move the entry into its own growing buffer
+        uint64_t capacity = std::max<uint64_t>(end, file.capacity * 2);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            uint64_t released = file.owned ? file.capacity : 0;
+            if (m_used - released + capacity > m_budget)
+            {
+                return false;
+            }
+            m_used = m_used - released + capacity;
+        }
+
+        std::unique_ptr<char[]> grown(new char[static_cast<size_t>(capacity)]);
+        if (file.size > 0)
+        {
+            memcpy(grown.get(), file.data, static_cast<size_t>(file.size));
+        }
+        file.owned = std::move(grown);
+        file.data = file.owned.get();
+        file.capacity = capacity;
+    }
+
+    // Holes (sparse entries) read as zeros
+    if (static_cast<uint64_t>(offset) > file.size)
+    {
+        memset(file.data + file.size, 0, static_cast<size_t>(offset - file.size));
+    }
+
+    if (size > 0)
+    {
+        memcpy(file.data + offset, data, size);
+    }
+    file.size = std::max(file.size, end);
+    return true;
+}
+
+const MemoryFile* MemoryFileTable::Find(const std::wstring& relativePath) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_byPath.find(relativePath);
+    return it != m_byPath.end() ? it->second : nullptr;
+}
+
+uint64_t MemoryFileTable::GetUsedBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_used;
+}
+
+bool MemoryFileTable::Flush(DirectoryCache& directories, const ExtractionOptions& options, std::wstring& error)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    LOG_INFO(L"Flushing " + std::to_wstring(m_files.size()) + L" in-memory entries (" + std::to_wstring(m_used) + L" bytes)");
+
+    for (const MemoryFile& file : m_files)
+    {
+        if (file.isDirectory)
+        {
+            directories.EnsureDirectory(file.path);
+            continue;
+        }
+
+        // Whole entry in one write; sizes are exact now, so preallocation is too
+        OutputFile out;
+        if (!directories.OpenOutputFile(file.path, false, static_cast<int64_t>(file.size), options, out))
+        {
+            if (GetLastError() == ERROR_DISK_FULL)
+            {
+                error = L"Not enough disk space for " + directories.GetRoot() + L"\\" + file.path;
+                return false;
+            }
+            LOG_ERROR(L"Failed to create file: " + directories.GetRoot() + L"\\" + file.path);
+            continue;
+        }
+
+        if ((file.size > 0 && !out.WriteAt(file.data, static_cast<size_t>(file.size), 0)) || !out.SetLength(file.size))
+        {
+            error = L"Failed to write file: " + directories.GetRoot() + L"\\" + file.path +
+                    L" (error " + std::to_wstring(GetLastError()) + L")";
+            return false;
+        }
+    }
+
+    Reset();
+    return true;
+}
+
+void MemoryFileTable::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Reset();
+}
+
+void MemoryFileTable::Reset()
+{
+    m_files.clear();
+    m_byPath.clear();
+    m_chunks.clear();
+    m_chunk = nullptr;
+    m_chunkUsed = 0;
+    m_chunkSize = 0;
+    m_used = 0;
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,86 @@
+#pragma once
+#include "../Core/ExtractionOptions.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ZipSpark {
+
+class DirectoryCache;
+
+/// <summary>
+/// One extracted entry held in memory
+/// </summary>
+struct MemoryFile
+{
+    std::wstring path;   // Relative, '\' separated (as produced by PathValidator)
+    bool isDirectory = false;
+    char* data = nullptr;
+    uint64_t size = 0;
+    uint64_t capacity = 0;
+    std::unique_ptr<char[]> owned;  // Set when the entry outgrew its arena reservation
+
+    std::string_view GetData() const { return std::string_view(data, static_cast<size_t>(size)); }
+};
+
+/// <summary>
+/// Extraction target that keeps entries in memory (ExtractionOptions::cacheToMemory).
+/// Entries with a known size are carved out of large arena chunks; all memory
+/// counts against a fixed budget. Callers read entries back in place, or
+/// Flush writes the whole table to disk in one sequential pass.
+/// Adding entries is thread-safe; each entry is written by one thread.
+/// </summary>
+class MemoryFileTable
+{
+public:
+    explicit MemoryFileTable(uint64_t budget);
+
+    // New file entry; sizeHint is the final size if known (-1 otherwise).
+    // Returns nullptr if it does not fit in the remaining budget.
+    MemoryFile* AddFile(const std::wstring& relativePath, int64_t sizeHint);
+    void AddDirectory(const std::wstring& relativePath);
+
+    // Write a block at an offset of the entry; gaps read as zeros.
+    // Returns false if growing the entry would exceed the budget.
+    bool Write(MemoryFile& file, const void* data, size_t size, int64_t offset);
+
+    // Entry by relative path (the last one if the archive stores duplicates)
+    const MemoryFile* Find(const std::wstring& relativePath) const;
+    const std::deque<MemoryFile>& GetFiles() const { return m_files; }
+
+    uint64_t GetUsedBytes() const;
+    uint64_t GetBudget() const { return m_budget; }
+
+    // Write every entry under the cache root in archive order, then release the memory
+    bool Flush(DirectoryCache& directories, const ExtractionOptions& options, std::wstring& error);
+
+    void Clear();
+
+private:
+    MemoryFileTable(const MemoryFileTable&) = delete;
+    MemoryFileTable& operator=(const MemoryFileTable&) = delete;
+
+    // Bump allocation from the current chunk (m_mutex held)
+    char* Allocate(uint64_t size);
+    // Drop all entries and memory (m_mutex held)
+    void Reset();
+
+    uint64_t m_budget;
+    uint64_t m_used = 0;        // Chunk and owned-buffer bytes charged to the budget
+    mutable std::mutex m_mutex;
+
+    std::vector<std::unique_ptr<char[]>> m_chunks;  // Arena chunks and dedicated large blocks
+    char* m_chunk = nullptr;                         // Chunk currently bump-allocated from
+    size_t m_chunkUsed = 0;
+    size_t m_chunkSize = 0;
+
+    std::deque<MemoryFile> m_files;  // Stable addresses for the writers
+    std::unordered_map<std::wstring, MemoryFile*> m_byPath;
+};
+
+} // namespace ZipSpark
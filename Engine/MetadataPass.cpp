@@ -0,0 +1,139 @@
+#include "pch.h"
+#include "MetadataPass.h"
+#include "../Utils/Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace ZipSpark {
+
+// FILETIME counts 100 ns intervals since 1601-01-01
+constexpr int64_t UNIX_EPOCH_SECONDS = 11644473600ll;
+constexpr int64_t TICKS_PER_SECOND = 10000000ll;
+
+// Files per thread below which the pass is not split
+constexpr size_t MIN_FILES_PER_THREAD = 256;
+
+MetadataPass::MetadataPass(const std::wstring& root)
+    : m_root(root)
+{
+    while (!m_root.empty() && (m_root.back() == L'\\' || m_root.back() == L'/'))
+    {
+        m_root.pop_back();
+    }
+}
+
+int64_t MetadataPass::UnixToFileTime(int64_t seconds, long nanoseconds)
+{
+    return (seconds + UNIX_EPOCH_SECONDS) * TICKS_PER_SECOND + nanoseconds / 100;
+}
+
+void MetadataPass::Record(std::wstring_view relativePath, bool isDirectory, int64_t modified, int64_t accessed, int64_t created,
+                          bool readOnly)
+{
+    Entry record;
+    record.pathLength = static_cast<uint32_t>(relativePath.size());
+    record.modified = modified;
+    record.accessed = accessed;
+    record.created = created;
+    record.depth = static_cast<uint16_t>(std::min<size_t>(std::count(relativePath.begin(), relativePath.end(), L'\\'), UINT16_MAX));
+    record.flags = static_cast<uint8_t>((isDirectory ? Directory : 0) | (readOnly ? ReadOnly : 0));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    record.pathOffset = static_cast<uint32_t>(m_paths.size());
+    m_paths.append(relativePath);
+    m_records.push_back(record);
+}
+
+bool MetadataPass::ApplyEntry(const Entry& record) const
+{
+    bool isDirectory = (record.flags & Directory) != 0;
+    std::wstring fullPath = m_root + L"\\" + m_paths.substr(record.pathOffset, record.pathLength);
+
+    HANDLE handle = CreateFileW(fullPath.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_FLAG_OPEN_REPARSE_POINT | (isDirectory ? FILE_FLAG_BACKUP_SEMANTICS : 0),
+                                nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    // Zero fields are left unchanged. Read-only on a directory only marks it
+    // as customized in Explorer, so directories keep their attributes.
+    FILE_BASIC_INFO info = {};
+    info.CreationTime.QuadPart = record.created;
+    info.LastAccessTime.QuadPart = record.accessed;
+    info.LastWriteTime.QuadPart = record.modified;
+    info.FileAttributes = (!isDirectory && (record.flags & ReadOnly)) ? FILE_ATTRIBUTE_READONLY : 0;
+
+    bool applied = SetFileInformationByHandle(handle, FileBasicInfo, &info, sizeof(info)) != FALSE;
+    CloseHandle(handle);
+    return applied;
+}
+
+size_t MetadataPass::Apply(uint32_t threadCount)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Files first: nothing below touches them afterwards
+    std::vector<const Entry*> files;
+    std::vector<const Entry*> directories;
+    files.reserve(m_records.size());
+    for (const auto& record : m_records)
+    {
+        (record.flags & Directory ? directories : files).push_back(&record);
+    }
+
+    std::atomic<size_t> failures{ 0 };
+    size_t workerCount = std::max<size_t>(1, std::min<size_t>(threadCount, files.size() / MIN_FILES_PER_THREAD));
+    auto applyRange = [&](size_t begin, size_t end) {
+        size_t failed = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!ApplyEntry(*files[i]))
+            {
+                failed++;
+            }
+        }
+        failures.fetch_add(failed, std::memory_order_relaxed);
+    };
+
+    if (workerCount > 1)
+    {
+        std::vector<std::thread> workers;
+        size_t perWorker = (files.size() + workerCount - 1) / workerCount;
+        for (size_t begin = 0; begin < files.size(); begin += perWorker)
+        {
+            workers.emplace_back(applyRange, begin, std::min(begin + perWorker, files.size()));
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+    else
+    {
+        applyRange(0, files.size());
+    }
+
+    // Then directories, children before parents; stable so duplicates keep archive order
+    std::stable_sort(directories.begin(), directories.end(),
+                     [](const Entry* a, const Entry* b) { return a->depth > b->depth; });
+    for (const Entry* record : directories)
+    {
+        if (!ApplyEntry(*record))
+        {
+            failures++;
+        }
+    }
+
+    LOG_INFO(L"Applied metadata to " + std::to_wstring(m_records.size() - failures) + L" of " +
+             std::to_wstring(m_records.size()) + L" entries");
+    if (failures > 0)
+    {
+        LOG_WARNING(L"Could not apply metadata to " + std::to_wstring(failures.load()) + L" entries");
+    }
+    return failures;
+}
+
+} // namespace ZipSpark
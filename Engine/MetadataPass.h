@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Deferred timestamps and read-only attributes of extracted entries.
+/// Entries are recorded into a compact array while decoding and applied in one
+/// pass once every file is written: files on a pool of threads, then
+/// directories deepest first, so writing their contents no longer disturbs a
+/// directory's restored times. Recording is thread-safe.
+/// </summary>
+class MetadataPass
+{
+public:
+    // Root the relative paths are under ('\' separated, as produced by PathValidator)
+    explicit MetadataPass(const std::wstring& root);
+
+    // Times are FILETIME ticks (UTC), 0 leaves a time unchanged
+    void Record(std::wstring_view relativePath, bool isDirectory, int64_t modified, int64_t accessed, int64_t created,
+                bool readOnly);
+
+    bool IsEmpty() const { return m_records.empty(); }
+
+    // Apply everything recorded; returns the number of entries that could not be updated
+    size_t Apply(uint32_t threadCount);
+
+    // Unix time to FILETIME ticks
+    static int64_t UnixToFileTime(int64_t seconds, long nanoseconds);
+
+private:
+    MetadataPass(const MetadataPass&) = delete;
+    MetadataPass& operator=(const MetadataPass&) = delete;
+
+    enum Flags : uint8_t
+    {
+        Directory = 1 << 0,
+        ReadOnly = 1 << 1
+    };
+
+    struct Entry
+    {
+        uint32_t pathOffset;   // Relative path in m_paths
+        uint32_t pathLength;
+        int64_t modified;
+        int64_t accessed;
+        int64_t created;
+        uint16_t depth;        // Path separators, for deepest-first directories
+        uint8_t flags;
+    };
+
+    bool ApplyEntry(const Entry& record) const;
+
+    std::wstring m_root;
+    std::mutex m_mutex;
+    std::vector<Entry> m_records;
+    std::wstring m_paths;
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,32 @@
+#include "pch.h"
+#include "OutputBackendFactory.h"
+#include "IoRingBackend.h"
+#include "WritePipeline.h"
+#include "../Utils/Logger.h"
+
+namespace ZipSpark {
+
+std::unique_ptr<IOutputBackend> OutputBackendFactory::CreateBackend(DirectoryCache& directories, const ExtractionOptions& options,
+                                                                    uint32_t writerCount, size_t slotCount, size_t slotSize)
+{
+    if (options.writeBackend != WriteBackend::ThreadPool)
+    {
+        if (IoRingBackend::IsSupported())
+        {
+            auto backend = std::make_unique<IoRingBackend>(directories, options, slotCount, slotSize);
+            if (backend->IsReady())
+            {
+                return backend;
+            }
+        }
+
+        if (options.writeBackend == WriteBackend::IoRing)
+        {
+            LOG_WARNING(L"I/O ring not available, using writer threads");
+        }
+    }
+
+    return std::make_unique<WritePipeline>(directories, options, writerCount, slotCount, slotSize);
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,19 @@
+#pragma once
+#include "IOutputBackend.h"
+#include "../Core/ExtractionOptions.h"
+#include <memory>
+
+namespace ZipSpark {
+
+class DirectoryCache;
+
+class OutputBackendFactory
+{
+public:
+    // Backend selected by options.writeBackend; Auto prefers an I/O ring and
+    // falls back to the writer thread pool where the system has none
+    static std::unique_ptr<IOutputBackend> CreateBackend(DirectoryCache& directories, const ExtractionOptions& options,
+                                                         uint32_t writerCount, size_t slotCount, size_t slotSize);
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,271 @@
+#include "pch.h"
+#include "OutputFile.h"
+#include <cstring>
+#include <new>
+
+namespace ZipSpark {
+
+// Word-at-a-time scan; only used on files already marked sparse
+static bool IsZeroBlock(const char* data, size_t size)
+{
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        if (word != 0)
+        {
+            return false;
+        }
+    }
+    for (; i < size; i++)
+    {
+        if (data[i] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void OutputFile::AlignedDelete::operator()(char* buffer) const
+{
+    ::operator delete[](buffer, std::align_val_t(BUFFER_ALIGNMENT));
+}
+
+OutputFile::OutputFile(HANDLE handle, size_t bufferSize, bool unbuffered)
+    : m_handle(handle)
+    , m_unbuffered(unbuffered)
+{
+    if (m_unbuffered && bufferSize == 0)
+    {
+        bufferSize = BUFFER_ALIGNMENT;
+    }
+
+    if (IsOpen() && bufferSize > 0)
+    {
+        m_bufferSize = (bufferSize + BUFFER_ALIGNMENT - 1) & ~(BUFFER_ALIGNMENT - 1);
+        m_buffer.reset(static_cast<char*>(::operator new[](m_bufferSize, std::align_val_t(BUFFER_ALIGNMENT))));
+    }
+}
+
+OutputFile::~OutputFile()
+{
+    Close();
+}
+
+OutputFile::OutputFile(OutputFile&& other) noexcept
+    : m_handle(other.m_handle)
+    , m_sparse(other.m_sparse)
+    , m_unbuffered(other.m_unbuffered)
+    , m_buffer(std::move(other.m_buffer))
+    , m_bufferSize(other.m_bufferSize)
+    , m_bufferFill(other.m_bufferFill)
+    , m_bufferOffset(other.m_bufferOffset)
+{
+    other.m_handle = INVALID_HANDLE_VALUE;
+    other.m_bufferSize = 0;
+    other.m_bufferFill = 0;
+}
+
+OutputFile& OutputFile::operator=(OutputFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        m_handle = other.m_handle;
+        m_sparse = other.m_sparse;
+        m_unbuffered = other.m_unbuffered;
+        m_buffer = std::move(other.m_buffer);
+        m_bufferSize = other.m_bufferSize;
+        m_bufferFill = other.m_bufferFill;
+        m_bufferOffset = other.m_bufferOffset;
+        other.m_handle = INVALID_HANDLE_VALUE;
+        other.m_bufferSize = 0;
+        other.m_bufferFill = 0;
+    }
+    return *this;
+}
+
+bool OutputFile::MarkSparse()
+{
+    // With an OVERLAPPED this also works on handles opened for asynchronous I/O
+    OVERLAPPED overlapped = {};
+    DWORD returned = 0;
+    m_sparse = DeviceIoControl(m_handle, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, &overlapped) != FALSE ||
+               (GetLastError() == ERROR_IO_PENDING && GetOverlappedResult(m_handle, &overlapped, &returned, TRUE));
+    return m_sparse;
+}
+
+bool OutputFile::Preallocate(uint64_t size)
+{
+    FILE_ALLOCATION_INFO info = {};
+    info.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+    return SetFileInformationByHandle(m_handle, FileAllocationInfo, &info, sizeof(info)) != FALSE;
+}
+
+bool OutputFile::WriteAt(const void* data, size_t size, int64_t offset)
+{
+    const char* source = static_cast<const char*>(data);
+    if (m_sparse && IsZeroBlock(source, size))
+    {
+        return true; // Leave the range unallocated; SetLength covers a trailing hole
+    }
+
+    if (!m_buffer)
+    {
+        return WriteThrough(source, size, offset);
+    }
+
+    int64_t bufferEnd = m_bufferOffset + static_cast<int64_t>(m_bufferFill);
+    if (m_unbuffered)
+    {
+        // Sector alignment only holds for ascending writes; fill gaps with zeros
+        if (offset < bufferEnd)
+        {
+            SetLastError(ERROR_INVALID_PARAMETER);
+            return false;
+        }
+        if (offset > bufferEnd && !Append(nullptr, static_cast<size_t>(offset - bufferEnd)))
+        {
+            return false;
+        }
+        return Append(source, size);
+    }
+
+    // Not contiguous with what is buffered: write that out first
+    if (m_bufferFill > 0 && offset != bufferEnd)
+    {
+        if (!Flush())
+        {
+            return false;
+        }
+    }
+
+    // Large blocks gain nothing from the copy
+    if (m_bufferFill == 0 && size >= m_bufferSize)
+    {
+        return WriteThrough(source, size, offset);
+    }
+
+    if (m_bufferFill == 0)
+    {
+        m_bufferOffset = offset;
+    }
+    return Append(source, size);
+}
+
+bool OutputFile::Append(const char* data, size_t size)
+{
+    while (size > 0)
+    {
+        size_t chunk = std::min(size, m_bufferSize - m_bufferFill);
+        if (data)
+        {
+            memcpy(m_buffer.get() + m_bufferFill, data, chunk);
+            data += chunk;
+        }
+        else
+        {
+            memset(m_buffer.get() + m_bufferFill, 0, chunk);
+        }
+        m_bufferFill += chunk;
+        size -= chunk;
+
+        if (m_bufferFill == m_bufferSize)
+        {
+            if (!WriteThrough(m_buffer.get(), m_bufferFill, m_bufferOffset))
+            {
+                return false;
+            }
+            m_bufferOffset += static_cast<int64_t>(m_bufferFill);
+            m_bufferFill = 0;
+        }
+    }
+    return true;
+}
+
+bool OutputFile::Flush()
+{
+    if (m_bufferFill == 0)
+    {
+        return true;
+    }
+
+    size_t writeSize = m_bufferFill;
+    if (m_unbuffered)
+    {
+        // Pad the tail to a whole sector; SetLength trims it afterwards
+        writeSize = (m_bufferFill + BUFFER_ALIGNMENT - 1) & ~(BUFFER_ALIGNMENT - 1);
+        memset(m_buffer.get() + m_bufferFill, 0, writeSize - m_bufferFill);
+    }
+
+    bool written = WriteThrough(m_buffer.get(), writeSize, m_bufferOffset);
+    m_bufferOffset += static_cast<int64_t>(m_bufferFill);
+    m_bufferFill = 0;
+    return written;
+}
+
+bool OutputFile::WriteThrough(const char* data, size_t size, int64_t offset)
+{
+    while (size > 0)
+    {
+        // Positioned write: gaps before the offset become holes (sparse) or are
+        // zero-filled by the file system, never written by us
+        OVERLAPPED position = {};
+        position.Offset = static_cast<DWORD>(static_cast<uint64_t>(offset));
+        position.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 0x40000000)); // WriteFile takes a DWORD
+        DWORD written = 0;
+        if (!WriteFile(m_handle, data, chunk, &written, &position) || written == 0)
+        {
+            return false;
+        }
+        data += written;
+        offset += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool OutputFile::SetLength(uint64_t length)
+{
+    if (!Flush())
+    {
+        return false;
+    }
+
+    FILE_END_OF_FILE_INFO info = {};
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(length);
+    return SetFileInformationByHandle(m_handle, FileEndOfFileInfo, &info, sizeof(info)) != FALSE;
+}
+
+void OutputFile::Close()
+{
+    if (m_handle != INVALID_HANDLE_VALUE)
+    {
+        Flush();
+        CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool OutputFile::Discard()
+{
+    if (m_handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    m_bufferFill = 0;
+    FILE_DISPOSITION_INFO info = {};
+    info.DeleteFile = TRUE;
+    bool deleted = SetFileInformationByHandle(m_handle, FileDispositionInfo, &info, sizeof(info)) != FALSE;
+
+    CloseHandle(m_handle);
+    m_handle = INVALID_HANDLE_VALUE;
+    return deleted;
+}
+
+} // namespace ZipSpark
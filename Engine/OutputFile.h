@@ -0,0 +1,88 @@
+#pragma once
+#include <windows.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Raw-handle file writer for extracted entries (replaces std::ofstream).
+/// Blocks are written at the offset the decoder reports, so holes in sparse
+/// entries are skipped rather than filled with zeros. Contiguous blocks are
+/// gathered in an aligned buffer and written in large chunks; with an
+/// unbuffered handle (FILE_FLAG_NO_BUFFERING) every write is sector aligned
+/// and the tail is trimmed by SetLength. Owns the handle; movable, not copyable.
+/// </summary>
+class OutputFile
+{
+public:
+    // Alignment of the write buffer; satisfies 512-byte and 4K-sector volumes
+    static constexpr size_t BUFFER_ALIGNMENT = 4096;
+
+    OutputFile() = default;
+    // bufferSize 0 writes every block straight through. An unbuffered handle
+    // needs a buffer; its size is rounded up to BUFFER_ALIGNMENT.
+    explicit OutputFile(HANDLE handle, size_t bufferSize = 0, bool unbuffered = false);
+    ~OutputFile();
+
+    OutputFile(OutputFile&& other) noexcept;
+    OutputFile& operator=(OutputFile&& other) noexcept;
+
+    bool IsOpen() const { return m_handle != INVALID_HANDLE_VALUE; }
+
+    // Underlying handle, for writers that bypass WriteAt (e.g. an I/O ring)
+    HANDLE GetHandle() const { return m_handle; }
+
+    // Mark the file sparse so skipped ranges stay unallocated.
+    // Returns false if the volume does not support it (writes still work).
+    bool MarkSparse();
+
+    // Reserve disk space for the final size up front: one contiguous
+    // allocation instead of growth on every write, and ERROR_DISK_FULL
+    // before any data is decoded. Returns false on failure (GetLastError is set).
+    bool Preallocate(uint64_t size);
+
+    // Write a block at an absolute offset. On sparse files all-zero blocks
+    // are left as holes. Returns false on failure (GetLastError is set).
+    bool WriteAt(const void* data, size_t size, int64_t offset);
+
+    // Write out buffered data
+    bool Flush();
+
+    // Flush and set the final logical size; covers trailing holes and
+    // trims the sector padding of unbuffered writes
+    bool SetLength(uint64_t length);
+
+    // Flushes (errors are lost; call Flush or SetLength first to see them)
+    void Close();
+
+    // Close and delete the file, dropping buffered data: for entries whose
+    // data could not be decoded (the handle needs DELETE access)
+    bool Discard();
+
+private:
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    struct AlignedDelete
+    {
+        void operator()(char* buffer) const;
+    };
+
+    bool WriteThrough(const char* data, size_t size, int64_t offset);
+
+    // Copy into the buffer at its end, writing it out whenever it fills (data == nullptr appends zeros)
+    bool Append(const char* data, size_t size);
+
+    HANDLE m_handle = INVALID_HANDLE_VALUE;
+    bool m_sparse = false;
+    bool m_unbuffered = false;
+
+    std::unique_ptr<char[], AlignedDelete> m_buffer;
+    size_t m_bufferSize = 0;
+    size_t m_bufferFill = 0;
+    int64_t m_bufferOffset = 0;  // File offset of m_buffer[0]
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,101 @@
+#include "pch.h"
+#include "ProgressAggregator.h"
+
+namespace ZipSpark {
+
+ProgressAggregator::ProgressAggregator(IProgressCallback* callback, uint64_t totalBytes, int totalFiles, uint32_t rateHz)
+    : m_callback(callback)
+    , m_totalBytes(totalBytes)
+    , m_totalFiles(totalFiles)
+    , m_period(1000 / std::max<uint32_t>(rateHz, 1))
+{
+}
+
+ProgressAggregator::~ProgressAggregator()
+{
+    Stop();
+}
+
+void ProgressAggregator::Start()
+{
+    if (m_callback && !m_thread.joinable())
+    {
+        m_thread = std::thread([this]() { Run(); });
+    }
+}
+
+void ProgressAggregator::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        if (m_stopping)
+        {
+            return;
+        }
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+        Emit(); // Whatever arrived after the last tick
+    }
+}
+
+void ProgressAggregator::AddFile(std::wstring_view name)
+{
+    m_files.fetch_add(1, std::memory_order_relaxed);
+
+    // Only the first entry after each tick pays for the copy
+    if (m_nameWanted.load(std::memory_order_relaxed) && m_nameWanted.exchange(false, std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(m_nameMutex);
+        m_latestName.assign(name.data(), name.size());
+        m_nameChanged = true;
+    }
+}
+
+void ProgressAggregator::Run()
+{
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    while (!m_wake.wait_for(lock, m_period, [this]() { return m_stopping; }))
+    {
+        lock.unlock();
+        Emit();
+        lock.lock();
+    }
+}
+
+void ProgressAggregator::Emit()
+{
+    std::wstring name;
+    bool nameChanged = false;
+    {
+        std::lock_guard<std::mutex> lock(m_nameMutex);
+        if (m_nameChanged)
+        {
+            name.swap(m_latestName);
+            m_nameChanged = false;
+            nameChanged = true;
+        }
+    }
+    m_nameWanted.store(true, std::memory_order_release);
+
+    if (nameChanged)
+    {
+        // Index of the file being extracted, as the engines reported it per entry
+        int files = m_files.load(std::memory_order_relaxed);
+        m_callback->OnFileProgress(name, std::max(files - 1, 0), m_totalFiles);
+    }
+
+    uint64_t bytes = m_bytes.load(std::memory_order_relaxed);
+    if (bytes != m_emittedBytes)
+    {
+        int percent = m_totalBytes > 0 ? static_cast<int>(std::min<uint64_t>((bytes * 100) / m_totalBytes, 100)) : 0;
+        m_callback->OnProgress(percent, bytes, m_totalBytes);
+        m_emittedBytes = bytes;
+    }
+}
+
+} // namespace ZipSpark
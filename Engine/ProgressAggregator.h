@@ -0,0 +1,77 @@
+#pragma once
+#include "../Core/ExtractionProgress.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Coalesces engine progress into fixed-rate snapshots.
+/// Engine threads only bump relaxed atomic counters; one emitter thread reads
+/// them at a fixed rate and is the only caller of OnProgress/OnFileProgress.
+/// The current file name is copied only when the emitter has asked for a
+/// fresh one, so most entries cost a counter increment and no allocation.
+/// </summary>
+class ProgressAggregator
+{
+public:
+    ProgressAggregator(IProgressCallback* callback, uint64_t totalBytes, int totalFiles, uint32_t rateHz = 30);
+    ~ProgressAggregator();
+
+    // Replace the totals (e.g. for a selection); call before Start
+    void SetTotals(uint64_t totalBytes, int totalFiles)
+    {
+        m_totalBytes = totalBytes;
+        m_totalFiles = totalFiles;
+    }
+
+    // Start emitting (after OnStart has been reported)
+    void Start();
+
+    // Emit a final snapshot and stop the emitter; call before OnComplete/OnError
+    void Stop();
+
+    void AddBytes(uint64_t bytes) { m_bytes.fetch_add(bytes, std::memory_order_relaxed); }
+
+    // Count an entry; its name becomes the displayed file if one is wanted
+    void AddFile(std::wstring_view name);
+
+    uint64_t GetBytes() const { return m_bytes.load(std::memory_order_relaxed); }
+
+private:
+    ProgressAggregator(const ProgressAggregator&) = delete;
+    ProgressAggregator& operator=(const ProgressAggregator&) = delete;
+
+    void Run();
+    void Emit();
+
+    IProgressCallback* m_callback;
+    uint64_t m_totalBytes;
+    int m_totalFiles;
+    std::chrono::milliseconds m_period;
+
+    std::atomic<uint64_t> m_bytes{ 0 };
+    std::atomic<int> m_files{ 0 };
+
+    // Set by the emitter, cleared by the first AddFile that publishes a name
+    std::atomic<bool> m_nameWanted{ true };
+    std::mutex m_nameMutex;
+    std::wstring m_latestName;
+    bool m_nameChanged = false;
+
+    // Last value handed to the callback (emitter thread only)
+    uint64_t m_emittedBytes = UINT64_MAX;
+
+    std::mutex m_stateMutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+} // namespace ZipSpark
@@ -1,7 +1,18 @@
 #include "pch.h"
 #include "SevenZipEngine.h"
+#include "ArchiveScanner.h"
+#include "ChildProcess.h"
+#include "DestinationSnapshot.h"
+#include "EntrySelector.h"
+#include "SevenZipListParser.h"
+#include "SevenZipOutputParser.h"
+#include "StallWatchdog.h"
 #include "../Utils/Logger.h"
+#include "../Utils/PathValidator.h"
+#include "../Utils/Utf8.h"
 #include <filesystem>
+#include <queue>
+#include <thread>
 #include <windows.h>
 #include <sstream>
 
@@ -15,16 +26,265 @@ SevenZipEngine::SevenZipEngine()
 
 SevenZipEngine::~SevenZipEngine()
 {
-    // Ensure handle is closed if still open (unlikely)
-    if (m_hSubProcess)
+}
+
+// Switches for machine-readable progress: percentage and current file on
+// stdout, names in UTF-8 regardless of the console code page
+static const wchar_t* const PROGRESS_SWITCHES[] = { L"-bsp1", L"-bso1", L"-sccUTF-8" };
+
+// A listing that stops producing output for this long is given up on
+constexpr uint32_t LISTING_STALL_TIMEOUT_MS = 60000;
+
+// Sharded extraction: at most this many 7z processes, each given at least
+// this much data (less is not worth another process)
+constexpr size_t MAX_SHARDS = 8;
+constexpr uint64_t MIN_SHARD_BYTES = 32ull * 1024 * 1024;
+
+/// <summary>
+/// Turns parsed 7-Zip output into IProgressCallback events, only when
+/// something changed, and keeps the first error line for the failure message.
+/// Counts the changes so the watchdog can tell a slow job from a stuck one.
+/// </summary>
+class SevenZipProgressForwarder : public SevenZipOutputParser::Listener
+{
+public:
+    SevenZipProgressForwarder(IProgressCallback* callback, uint64_t totalBytes, int totalFiles)
+        : m_callback(callback), m_totalBytes(totalBytes), m_totalFiles(totalFiles)
     {
-        CloseHandle(static_cast<HANDLE>(m_hSubProcess));
-        m_hSubProcess = nullptr;
     }
-}
 
-// Timeout for extraction process (30 seconds)
-constexpr DWORD EXTRACTION_TIMEOUT_MS = 30000;
+    void OnProgress(const SevenZipOutputParser::Progress& progress) override
+    {
+        if (progress.percent >= 0 && progress.percent != m_percent)
+        {
+            m_percent = progress.percent;
+            m_advances++;
+            if (m_callback) m_callback->OnProgress(m_percent, m_totalBytes / 100 * m_percent, m_totalBytes);
+        }
+        else if (progress.percent < 0 && progress.bytes != m_bytes)
+        {
+            m_bytes = progress.bytes;
+            m_advances++;
+            int percent = m_totalBytes ? static_cast<int>(std::min<uint64_t>(100, m_bytes * 100 / m_totalBytes)) : 0;
+            if (m_callback) m_callback->OnProgress(percent, m_bytes, m_totalBytes);
+        }
+
+        if (!progress.file.empty() && progress.file != m_file)
+        {
+            m_file.assign(progress.file.data(), progress.file.size());
+            m_advances++;
+            if (m_callback)
+            {
+                Utf8::ToWide(m_file, m_fileW);
+                m_callback->OnFileProgress(m_fileW, static_cast<int>(progress.files), m_totalFiles);
+            }
+        }
+    }
+
+    void OnLine(std::string_view line) override
+    {
+        LOG_DEBUGF(L"7-Zip: {}", line);
+
+        if (m_error.empty() && (line.substr(0, 6) == "ERROR:" || line.find("Wrong password") != std::string_view::npos ||
+                                line.find("Can not open") != std::string_view::npos))
+        {
+            m_error = Utf8::ToWide(line);
+        }
+    }
+
+    const std::wstring& GetError() const { return m_error; }
+
+    // Number of times the percentage, byte count or current file moved on
+    uint64_t GetAdvanceCount() const { return m_advances; }
+
+private:
+    IProgressCallback* m_callback;
+    uint64_t m_totalBytes;
+    int m_totalFiles;
+
+    int m_percent = -1;
+    uint64_t m_bytes = 0;
+    std::string m_file;
+    std::wstring m_fileW;
+    std::wstring m_error;
+    uint64_t m_advances = 0;
+};
+
+/// <summary>
+/// Builds the entry table and the archive totals from a technical listing,
+/// keeping the first error line in case the listing fails
+/// </summary>
+class SevenZipIndexBuilder : public SevenZipListParser::Listener
+{
+public:
+    SevenZipIndexBuilder() : m_index(std::make_shared<ArchiveIndex>()) {}
+
+    void OnEntry(const SevenZipListParser::Entry& entry) override
+    {
+        ArchiveIndexEntry indexEntry;
+        indexEntry.size = entry.size;
+        indexEntry.compressedSize = entry.packedSize;
+        indexEntry.modifiedTime = entry.modifiedTime;
+        indexEntry.crc = entry.crc;
+        indexEntry.attributes = entry.attributes;
+        indexEntry.block = entry.block;
+        indexEntry.flags = static_cast<uint16_t>(
+            (entry.isDirectory ? ArchiveIndexEntry::Directory : 0) |
+            (entry.isEncrypted ? ArchiveIndexEntry::Encrypted : 0));
+        m_index->AddEntry(entry.path, indexEntry);
+
+        if (entry.isDirectory)
+        {
+            m_summary.directoryCount++;
+        }
+        else
+        {
+            m_summary.fileCount++;
+            m_summary.totalSize += entry.size;
+            m_packedSize += entry.packedSize;
+        }
+        m_summary.isEncrypted = m_summary.isEncrypted || entry.isEncrypted;
+
+        // Everything under one root folder?
+        size_t rootLength = entry.path.find_first_of("/\\");
+        std::string_view root = entry.path.substr(0, rootLength);
+        if (root.empty())
+        {
+            return;
+        }
+        if (!m_sawRoot)
+        {
+            m_firstRoot.assign(root.data(), root.size());
+            m_sawRoot = true;
+        }
+        else if (root != m_firstRoot)
+        {
+            m_singleRoot = false;
+        }
+        if (entry.isDirectory || (rootLength != std::string_view::npos && rootLength + 1 < entry.path.size()))
+        {
+            m_rootIsDirectory = true;
+        }
+    }
+
+    void OnLine(std::string_view line) override
+    {
+        if (m_error.empty() && (line.substr(0, 6) == "ERROR:" || line.find("Wrong password") != std::string_view::npos ||
+                                line.find("Can not open") != std::string_view::npos))
+        {
+            m_error = Utf8::ToWide(line);
+        }
+    }
+
+    void Fill(ArchiveInfo& info, const SevenZipListParser::ArchiveProperties& archive)
+    {
+        m_summary.hasSingleRoot = m_sawRoot && m_singleRoot && m_rootIsDirectory;
+        m_index->SetSummary(m_summary);
+
+        info.totalSize = m_summary.totalSize;
+        info.packedSize = m_packedSize;
+        info.fileCount = m_summary.fileCount;
+        info.directoryCount = m_summary.directoryCount;
+        info.isEncrypted = m_summary.isEncrypted;
+        info.hasSingleRoot = m_summary.hasSingleRoot;
+        info.isSolid = archive.isSolid;
+        info.solidBlockCount = archive.isSolid ? archive.blockCount : 0;
+        info.index = m_index;
+    }
+
+    const std::wstring& GetError() const { return m_error; }
+
+private:
+    std::shared_ptr<ArchiveIndex> m_index;
+    ArchiveIndex::Summary m_summary;
+    uint64_t m_packedSize = 0;
+
+    std::string m_firstRoot;
+    bool m_sawRoot = false;
+    bool m_singleRoot = true;
+    bool m_rootIsDirectory = false;
+
+    std::wstring m_error;
+};
+
+/// <summary>
+/// Merges the progress of the 7z processes of a sharded extraction into one
+/// stream: bytes and finished files are summed over the shards, and the
+/// combined percentage goes out only when it changes. Shards report from
+/// their own threads, so everything is forwarded under one lock.
+/// </summary>
+class ShardProgressMerger
+{
+public:
+    /// <summary>
+    /// Progress callback handed to one shard's Run7z
+    /// </summary>
+    class ShardCallback : public IProgressCallback
+    {
+    public:
+        ShardCallback(ShardProgressMerger& merger, size_t shard) : m_merger(merger), m_shard(shard) {}
+
+        // Start and the final result are reported once, for the whole job
+        void OnStart(int) override {}
+        void OnComplete(const std::wstring&) override {}
+        void OnError(ErrorCode, const std::wstring&) override {}
+
+        void OnProgress(int, uint64_t bytesProcessed, uint64_t) override
+        {
+            m_merger.OnProgress(m_shard, bytesProcessed);
+        }
+
+        void OnFileProgress(const std::wstring& currentFile, int fileIndex, int) override
+        {
+            m_merger.OnFileProgress(m_shard, currentFile, fileIndex);
+        }
+
+    private:
+        ShardProgressMerger& m_merger;
+        size_t m_shard;
+    };
+
+    ShardProgressMerger(IProgressCallback* callback, uint64_t totalBytes, int totalFiles, size_t shardCount)
+        : m_callback(callback), m_totalBytes(totalBytes), m_totalFiles(totalFiles)
+        , m_bytes(shardCount, 0), m_files(shardCount, 0)
+    {
+    }
+
+private:
+    void OnProgress(size_t shard, uint64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sumBytes += bytes - m_bytes[shard];
+        m_bytes[shard] = bytes;
+
+        int percent = m_totalBytes ? static_cast<int>(std::min<uint64_t>(100, m_sumBytes * 100 / m_totalBytes)) : 0;
+        if (percent != m_percent && m_callback)
+        {
+            m_percent = percent;
+            m_callback->OnProgress(percent, m_sumBytes, m_totalBytes);
+        }
+    }
+
+    void OnFileProgress(size_t shard, const std::wstring& currentFile, int files)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sumFiles += files - m_files[shard];
+        m_files[shard] = files;
+
+        if (m_callback) m_callback->OnFileProgress(currentFile, m_sumFiles, m_totalFiles);
+    }
+
+    IProgressCallback* m_callback;
+    uint64_t m_totalBytes;
+    int m_totalFiles;
+
+    std::mutex m_mutex;
+    std::vector<uint64_t> m_bytes;
+    std::vector<int> m_files;
+    uint64_t m_sumBytes = 0;
+    int m_sumFiles = 0;
+    int m_percent = -1;
+};
 
 bool SevenZipEngine::CanHandle(const std::wstring& archivePath)
 {
@@ -46,15 +306,22 @@ ArchiveInfo SevenZipEngine::GetArchiveInfo(const std::wstring& archivePath)
     ArchiveInfo info;
     info.archivePath = archivePath;
     
-    // For now, basic info. Detailed info would require parsing "7z l" output.
     try
     {
         fs::path path(archivePath);
-        if (fs::exists(path))
+
+        // 7-Zip's own listing; without 7z.exe, a libarchive header scan.
+        // Formats neither can read keep the file size and unknown counts.
+        std::wstring exe7z = Get7zExePath();
+        if ((exe7z.empty() || !ListArchive(exe7z, archivePath, info)) &&
+            !ArchiveScanner::Scan(archivePath, ArchiveScanner::Mode::Full, info))
         {
-            info.totalSize = fs::file_size(path);
+            if (fs::exists(path))
+            {
+                info.totalSize = fs::file_size(path);
+            }
+            info.fileCount = 0;
         }
-        info.fileCount = 0; // Placeholder
         
         // Guess format based on extension for metadata
         std::wstring ext = path.extension().wstring();
@@ -70,6 +337,68 @@ ArchiveInfo SevenZipEngine::GetArchiveInfo(const std::wstring& archivePath)
     return info;
 }
 
+bool SevenZipEngine::ListArchive(const std::wstring& exe7z, const std::wstring& archivePath, ArchiveInfo& info)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    
+    ChildProcess process;
+    std::wstring error;
+    if (!process.Start(exe7z, { L"l", L"-slt", L"-sccUTF-8", archivePath }, error))
+    {
+        LOG_WARNING(L"Failed to start 7z.exe for listing: " + error);
+        return false;
+    }
+    
+    SevenZipIndexBuilder builder;
+    SevenZipListParser parser(builder);
+    StallWatchdog watchdog(LISTING_STALL_TIMEOUT_MS, 0);
+    uint64_t received = 0;
+    
+    // Large reads: a listing arrives much faster than progress output
+    std::vector<char> buffer(64 * 1024);
+    while (true)
+    {
+        size_t bytesRead = 0;
+        ChildProcess::ReadResult read = process.Read(buffer.data(), buffer.size(), 100, bytesRead);
+        if (read == ChildProcess::ReadResult::End)
+        {
+            break;
+        }
+        if (read == ChildProcess::ReadResult::Data)
+        {
+            parser.Feed(buffer.data(), bytesRead);
+            received += bytesRead;
+            watchdog.Observe(received);
+        }
+        
+        if (watchdog.Check() != StallWatchdog::Verdict::Running)
+        {
+            LOG_ERROR(L"7z.exe listing made no progress for " + std::to_wstring(watchdog.GetIdleMs()) + L"ms");
+            process.Terminate();
+            process.Wait();
+            return false;
+        }
+    }
+    parser.Finish();
+    
+    int exitCode = process.Wait();
+    if (exitCode != 0 || !parser.SawEntries())
+    {
+        LOG_WARNING(L"7-Zip could not list the archive (code " + std::to_wstring(exitCode) + L")" +
+                    (builder.GetError().empty() ? L"" : L": " + builder.GetError()));
+        return false;
+    }
+    
+    builder.Fill(info, parser.GetArchiveProperties());
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    LOG_INFO(L"7-Zip listing: " + std::to_wstring(info.fileCount) + L" files, " + std::to_wstring(info.directoryCount) +
+             L" directories, " + std::to_wstring(info.totalSize) + L" bytes (" + std::to_wstring(info.packedSize) +
+             L" packed" + (info.isSolid ? L", " + std::to_wstring(info.solidBlockCount) + L" solid blocks" : L"") +
+             L") in " + std::to_wstring(elapsed) + L" ms");
+    return true;
+}
+
 std::wstring SevenZipEngine::Get7zExePath()
 {
     // Assuming 7z.exe is next to the executable or in External/7-Zip
@@ -100,14 +429,29 @@ std::wstring SevenZipEngine::DetermineDestination(const ArchiveInfo& info, const
         return options.destinationPath;
     }
     
+    // A single root folder already keeps the contents together
+    if (info.hasSingleRoot || !options.createSubfolder)
+    {
+        return parentDir.wstring();
+    }
+    
     // Default: Extract to subfolder
     std::wstring folderName = archivePath.stem().wstring();
+    
+    // Handle .tar.gz and .tar.xz (double extension)
+    if (folderName.length() >= 4 && 
+        folderName.substr(folderName.length() - 4) == L".tar")
+    {
+        folderName = folderName.substr(0, folderName.length() - 4);
+    }
+    
     return (parentDir / folderName).wstring();
 }
 
 void SevenZipEngine::Extract(const ArchiveInfo& info, const ExtractionOptions& options, IProgressCallback* callback)
 {
     m_cancelled = false;
+    m_abortShards = false;
     
     std::wstring exe7z = Get7zExePath();
     if (exe7z.empty())
@@ -127,135 +471,356 @@ void SevenZipEngine::Extract(const ArchiveInfo& info, const ExtractionOptions& o
     
     std::wstring dest = DetermineDestination(info, options);
     
-    // Command: 7z.exe x "Archive" -o"Dest" -y
-    std::wstringstream cmd;
-    cmd << L"\"" << exe7z << L"\" x \"" << info.archivePath << L"\" -o\"" << dest << L"\" -y";
-    
-    if (callback) callback->OnStart(0); // Indeterminate start
-    
-    LOG_INFO(L"Launching 7-Zip: " + cmd.str());
+    // Prompt is settled before launch: the archive's directories are listed, one question
+    OverwritePolicy policy = options.overwritePolicy;
+    if (policy == OverwritePolicy::Prompt)
+    {
+        DestinationSnapshot existing(dest);
+        policy = existing.ResolvePolicy(policy, info, EntrySelector(options.selection), PathValidator(dest), callback);
+    }
     
-    STARTUPINFOW si = { sizeof(si) };
-    PROCESS_INFORMATION pi = { 0 };
+    // Command: 7z.exe x "Archive" -o"Dest" -y -ao{a|s|u} [@listfile] plus the progress switches
+    std::vector<std::wstring> arguments = { L"x", info.archivePath, L"-o" + dest, L"-y" };
+    switch (policy)
+    {
+    case OverwritePolicy::Overwrite:
+        arguments.push_back(L"-aoa");
+        break;
+    case OverwritePolicy::Skip:
+        arguments.push_back(L"-aos");
+        break;
+    default:
+        arguments.push_back(L"-aou"); // Rename extracted files, like AutoRename
+        break;
+    }
+    arguments.insert(arguments.end(), std::begin(PROGRESS_SWITCHES), std::end(PROGRESS_SWITCHES));
     
-    // We need a mutable string for CreateProcess
-    std::wstring cmdStr = cmd.str();
-    std::vector<wchar_t> cmdVec(cmdStr.begin(), cmdStr.end());
-    cmdVec.push_back(0);
+    int exitCode = 0;
+    std::wstring message;
+    RunResult result;
     
-    if (CreateProcessW(NULL, cmdVec.data(), NULL, NULL, FALSE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi))
+    // Non-solid archives with enough data are split across several 7z processes
+    std::vector<Shard> shards;
+    std::vector<std::wstring> directories;
+    if (PlanShards(info, options, shards, directories))
     {
-        m_hSubProcess = pi.hProcess; // Store for cancellation (naive, thread safety needed usually but simplified here)
-        CloseHandle(pi.hThread);
-        
-        LOG_INFO(L"7z.exe process started successfully");
+        LOG_INFO(L"Sharded extraction: " + std::to_wstring(info.fileCount) + L" files in " +
+                 std::to_wstring(shards.size()) + L" 7z processes");
         
-        // Wait for it to finish with timeout
-        // Track total elapsed time to implement timeout
-        auto startTime = std::chrono::steady_clock::now();
-        DWORD totalElapsed = 0;
+        if (callback) callback->OnStart(info.fileCount);
+        result = RunShards(exe7z, arguments, shards, info.totalSize, info.fileCount, options, callback, exitCode, message);
         
-        while (true)
+        // Directories stay out of the shards (7-Zip would extract everything
+        // under them); this creates the empty ones
+        if (result == RunResult::Finished && exitCode == 0)
         {
-            DWORD waitResult = WaitForSingleObject(pi.hProcess, 100);
-            
-            if (waitResult == WAIT_OBJECT_0)
-            {
-                // Process completed
-                LOG_INFO(L"7z.exe process completed");
-                break;
-            }
-            else if (waitResult == WAIT_TIMEOUT)
+            PathValidator validator(dest);
+            std::wstring relativePath;
+            for (const std::wstring& directory : directories)
             {
-                // Check for cancellation
-                if (m_cancelled)
+                std::error_code ec;
+                if (validator.Resolve(directory, relativePath))
                 {
-                    LOG_INFO(L"Terminating 7z.exe due to user cancellation...");
-                    TerminateProcess(pi.hProcess, 1);
-                    break;
+                    fs::create_directories(validator.GetFullPath(relativePath), ec);
                 }
-                
-                // Check for timeout (30 seconds)
-                auto now = std::chrono::steady_clock::now();
-                totalElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count();
-                
-                if (totalElapsed > EXTRACTION_TIMEOUT_MS)
-                {
-                    LOG_ERROR(L"7z.exe process timed out after " + std::to_wstring(totalElapsed) + L"ms");
-                    TerminateProcess(pi.hProcess, 1);
-                    CloseHandle(pi.hProcess);
-                    m_hSubProcess = nullptr;
-                    
-                    if (callback)
-                    {
-                        callback->OnError(ErrorCode::ExtractionFailed, 
-                            L"Extraction timed out after 30 seconds.\n\n"
-                            L"The archive may be corrupted or too large.");
-                    }
-                    return;
-                }
-                
-                // Continue waiting
-                continue;
             }
-            else
+        }
+    }
+    else
+    {
+        // Selective extraction: 7-Zip seeks to the listed items itself
+        std::wstring listFileName;
+        if (!options.selection.empty())
+        {
+            listFileName = WriteListFile(options.selection);
+            if (listFileName.empty())
             {
-                // Wait failed
-                DWORD err = GetLastError();
-                LOG_ERROR(L"WaitForSingleObject failed with error: " + std::to_wstring(err));
-                break;
+                if (callback) callback->OnError(ErrorCode::UnknownError, L"Failed to create temporary list file");
+                return;
             }
+            arguments.push_back(L"@" + listFileName);
         }
         
-        DWORD exitCode = 0;
-        GetExitCodeProcess(pi.hProcess, &exitCode);
+        if (callback) callback->OnStart(info.fileCount); // 0 = indeterminate
         
-        CloseHandle(pi.hProcess);
-        m_hSubProcess = nullptr;
+        result = Run7z(exe7z, arguments, info.totalSize, info.fileCount, options.stallTimeoutMs, options.deadlineMs,
+                       callback, exitCode, message);
         
-        if (m_cancelled)
+        // Cleanup list file
+        if (!listFileName.empty()) DeleteFileW(listFileName.c_str());
+    }
+    
+    switch (result)
+    {
+    case RunResult::LaunchFailed:
+        LOG_ERROR(L"Failed to start 7z.exe: " + message);
+        if (callback) callback->OnError(ErrorCode::UnknownError, L"Failed to launch extractor. " + message);
+        break;
+    case RunResult::Stalled:
+        if (callback)
         {
-             LOG_INFO(L"Extraction was cancelled by user");
-             if (callback) callback->OnError(ErrorCode::CancellationRequested, L"Cancelled");
-             return;
+            callback->OnError(ErrorCode::ExtractionFailed,
+                L"Extraction stopped making progress for " + std::to_wstring(options.stallTimeoutMs / 1000) + L" seconds.\n\n"
+                L"The archive may be corrupted, or the disk is not responding.");
         }
-        
+        break;
+    case RunResult::DeadlineExceeded:
+        if (callback)
+        {
+            callback->OnError(ErrorCode::ExtractionFailed,
+                L"Extraction did not finish within the configured limit of " + std::to_wstring(options.deadlineMs / 1000) + L" seconds.");
+        }
+        break;
+    case RunResult::Cancelled:
+        LOG_INFO(L"Extraction was cancelled by user");
+        if (callback) callback->OnError(ErrorCode::CancellationRequested, L"Cancelled");
+        break;
+    case RunResult::Finished:
         if (exitCode == 0)
         {
-             LOG_INFO(L"7-Zip finished successfully.");
-             if (callback) callback->OnComplete(dest);
+            LOG_INFO(L"7-Zip finished successfully.");
+            if (callback)
+            {
+                callback->OnProgress(100, info.totalSize, info.totalSize);
+                callback->OnComplete(dest);
+            }
         }
         else
         {
-             LOG_ERROR(L"7-Zip exited with code: " + std::to_wstring(exitCode));
-             if (callback) callback->OnError(ErrorCode::ExtractionFailed, L"7-Zip Error Code: " + std::to_wstring(exitCode));
+            LOG_ERROR(L"7-Zip exited with code: " + std::to_wstring(exitCode));
+            if (callback)
+            {
+                callback->OnError(ErrorCode::ExtractionFailed,
+                    message.empty() ? L"7-Zip Error Code: " + std::to_wstring(exitCode) : message);
+            }
         }
+        break;
     }
-    else
+}
+
+SevenZipEngine::RunResult SevenZipEngine::Run7z(const std::wstring& exe7z, const std::vector<std::wstring>& arguments,
+                                                uint64_t totalBytes, int totalFiles, uint32_t stallTimeoutMs,
+                                                uint32_t deadlineMs, IProgressCallback* callback, int& exitCode,
+                                                std::wstring& message)
+{
+    std::wstring commandLine = exe7z;
+    for (const std::wstring& argument : arguments)
     {
-        DWORD err = GetLastError();
-        LOG_ERROR(L"Failed to start 7z.exe. Error: " + std::to_wstring(err));
-        if (callback) callback->OnError(ErrorCode::UnknownError, L"Failed to launch extractor. Error code: " + std::to_wstring(err));
+        commandLine += L" " + argument;
     }
+    LOG_INFO(L"Launching 7-Zip: " + commandLine);
+    
+    ChildProcess process;
+    if (!process.Start(exe7z, arguments, message))
+    {
+        return RunResult::LaunchFailed;
+    }
+    
+    LOG_INFO(L"7z.exe process started successfully");
+    
+    SevenZipProgressForwarder forwarder(callback, totalBytes, totalFiles);
+    SevenZipOutputParser parser(forwarder);
+    StallWatchdog watchdog(stallTimeoutMs, deadlineMs);
+    char buffer[4096];
+    
+    // Output arrives as 7-Zip redraws its progress; the read timeout lets
+    // cancellation and the watchdog be checked while it is silent
+    while (true)
+    {
+        size_t bytesRead = 0;
+        ChildProcess::ReadResult read = process.Read(buffer, sizeof(buffer), 100, bytesRead);
+        if (read == ChildProcess::ReadResult::End)
+        {
+            break;
+        }
+        if (read == ChildProcess::ReadResult::Data)
+        {
+            parser.Feed(buffer, bytesRead);
+            watchdog.Observe(forwarder.GetAdvanceCount());
+        }
+        
+        if (m_cancelled || m_abortShards)
+        {
+            LOG_INFO(m_cancelled ? L"Terminating 7z.exe due to user cancellation..." :
+                                   L"Terminating 7z.exe: another shard failed");
+            process.Terminate();
+            process.Wait();
+            return RunResult::Cancelled;
+        }
+        
+        StallWatchdog::Verdict verdict = watchdog.Check();
+        if (verdict != StallWatchdog::Verdict::Running)
+        {
+            LOG_ERROR(verdict == StallWatchdog::Verdict::Stalled ?
+                L"7z.exe made no progress for " + std::to_wstring(watchdog.GetIdleMs()) + L"ms" :
+                L"7z.exe passed its deadline after " + std::to_wstring(watchdog.GetElapsedMs()) + L"ms");
+            process.Terminate();
+            process.Wait();
+            return verdict == StallWatchdog::Verdict::Stalled ? RunResult::Stalled : RunResult::DeadlineExceeded;
+        }
+    }
+    parser.Finish();
+    
+    exitCode = process.Wait();
+    LOG_INFO(L"7z.exe process completed");
+    message = forwarder.GetError();
+    return m_cancelled ? RunResult::Cancelled : RunResult::Finished;
 }
 
-void SevenZipEngine::CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>& sourceFiles, const std::wstring& format, IProgressCallback* callback)
+bool SevenZipEngine::PlanShards(const ArchiveInfo& info, const ExtractionOptions& options, std::vector<Shard>& shards,
+                                std::vector<std::wstring>& directories) const
 {
-    m_cancelled = false;
+    // Entries of a solid block decode one after another whatever the process
+    // count. ZIP is never solid; other formats need the listing's answer
+    // (the packed total is only known from a listing).
+    bool independentEntries = info.format == ArchiveFormat::ZIP || (info.packedSize > 0 && !info.isSolid);
+    if (!info.index || !independentEntries || info.totalSize < 2 * MIN_SHARD_BYTES)
+    {
+        return false;
+    }
     
-    std::wstring exe7z = Get7zExePath();
-    if (exe7z.empty())
+    unsigned int threads = options.threadCount > 0 ? options.threadCount : std::thread::hardware_concurrency();
+    size_t shardCount = std::min<size_t>({ MAX_SHARDS, threads, static_cast<size_t>(info.totalSize / MIN_SHARD_BYTES),
+                                           static_cast<size_t>(info.fileCount) });
+    if (shardCount < 2)
     {
-        LOG_ERROR(L"7z.exe not found!");
-        if (callback) 
+        return false;
+    }
+    
+    // Selected files, largest first
+    EntrySelector selector(options.selection);
+    std::vector<size_t> files;
+    files.reserve(info.index->GetEntryCount());
+    for (size_t i = 0; i < info.index->GetEntryCount(); i++)
+    {
+        const ArchiveIndexEntry& entry = info.index->GetEntry(i);
+        if (!selector.Matches(info.index->GetName(entry)))
         {
-            callback->OnError(ErrorCode::ExtractionFailed, L"7z.exe is missing. Cannot create archive.");
+            continue;
+        }
+        if (entry.IsDirectory())
+        {
+            directories.push_back(Utf8::ToWide(info.index->GetName(entry)));
+        }
+        else
+        {
+            files.push_back(i);
         }
-        return;
     }
+    std::sort(files.begin(), files.end(), [&](size_t a, size_t b) {
+        return info.index->GetEntry(a).size > info.index->GetEntry(b).size;
+    });
     
-    // Create temporary file list
-    // 7-Zip supports list files with @listfile
+    // Each file goes to the shard with the least data so far
+    using Load = std::pair<uint64_t, size_t>; // (bytes, shard)
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+    shards.assign(shardCount, Shard());
+    for (size_t shard = 0; shard < shardCount; shard++)
+    {
+        loads.push({ 0, shard });
+    }
+    for (size_t i : files)
+    {
+        const ArchiveIndexEntry& entry = info.index->GetEntry(i);
+        Load load = loads.top();
+        loads.pop();
+        
+        Shard& shard = shards[load.second];
+        shard.paths.push_back(Utf8::ToWide(info.index->GetName(entry)));
+        shard.bytes += entry.size;
+        loads.push({ shard.bytes, load.second });
+    }
+    
+    // One huge file can leave the others with little to do
+    shards.erase(std::remove_if(shards.begin(), shards.end(), [](const Shard& shard) { return shard.paths.empty(); }),
+                 shards.end());
+    return shards.size() >= 2;
+}
+
+SevenZipEngine::RunResult SevenZipEngine::RunShards(const std::wstring& exe7z, const std::vector<std::wstring>& arguments,
+                                                    const std::vector<Shard>& shards, uint64_t totalBytes, int totalFiles,
+                                                    const ExtractionOptions& options, IProgressCallback* callback,
+                                                    int& exitCode, std::wstring& message)
+{
+    struct ShardRun
+    {
+        std::wstring listFileName;
+        RunResult result = RunResult::LaunchFailed;
+        int exitCode = 0;
+        std::wstring message;
+    };
+    std::vector<ShardRun> runs(shards.size());
+    
+    for (size_t i = 0; i < shards.size(); i++)
+    {
+        runs[i].listFileName = WriteListFile(shards[i].paths);
+        if (runs[i].listFileName.empty())
+        {
+            for (const ShardRun& run : runs)
+            {
+                if (!run.listFileName.empty()) DeleteFileW(run.listFileName.c_str());
+            }
+            message = L"Failed to create temporary list file";
+            return RunResult::LaunchFailed;
+        }
+    }
+    
+    ShardProgressMerger merger(callback, totalBytes, totalFiles, shards.size());
+    m_abortShards = false;
+    
+    std::vector<std::thread> threads;
+    threads.reserve(shards.size());
+    for (size_t i = 0; i < shards.size(); i++)
+    {
+        threads.emplace_back([&, i]() {
+            // -spd: list entries are names, not wildcards
+            std::vector<std::wstring> shardArguments = arguments;
+            shardArguments.push_back(L"-spd");
+            shardArguments.push_back(L"@" + runs[i].listFileName);
+            
+            ShardProgressMerger::ShardCallback shardCallback(merger, i);
+            ShardRun& run = runs[i];
+            run.result = Run7z(exe7z, shardArguments, shards[i].bytes, static_cast<int>(shards[i].paths.size()),
+                               options.stallTimeoutMs, options.deadlineMs, &shardCallback, run.exitCode, run.message);
+            if (run.result != RunResult::Finished || run.exitCode != 0)
+            {
+                m_abortShards = true;
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    
+    for (const ShardRun& run : runs)
+    {
+        DeleteFileW(run.listFileName.c_str());
+    }
+    
+    if (m_cancelled)
+    {
+        return RunResult::Cancelled;
+    }
+    
+    // The shard that failed first on its own; the rest were stopped because of it
+    for (const ShardRun& run : runs)
+    {
+        if (run.result == RunResult::Cancelled || (run.result == RunResult::Finished && run.exitCode == 0))
+        {
+            continue;
+        }
+        exitCode = run.exitCode;
+        message = run.message;
+        return run.result;
+    }
+    
+    exitCode = 0;
+    return RunResult::Finished;
+}
+
+std::wstring SevenZipEngine::WriteListFile(const std::vector<std::wstring>& paths)
+{
     WCHAR tempPath[MAX_PATH];
     GetTempPathW(MAX_PATH, tempPath);
     WCHAR listFileName[MAX_PATH];
@@ -266,83 +831,90 @@ void SevenZipEngine::CreateArchive(const std::wstring& destinationPath, const st
     if (!f)
     {
         LOG_ERROR(L"Failed to create list file");
-        if (callback) callback->OnError(ErrorCode::UnknownError, L"Failed to create temporary list file");
-        return;
+        return L"";
     }
     
-    for (const auto& file : sourceFiles)
+    for (const auto& path : paths)
     {
-        fwprintf(f, L"%s\n", file.c_str());
+        fwprintf(f, L"%s\n", path.c_str());
     }
     fclose(f);
+    return listFileName;
+}
+
+void SevenZipEngine::CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>& sourceFiles, const std::wstring& format, const CompressionProfile& profile, IProgressCallback* callback)
+{
+    m_cancelled = false;
+    m_abortShards = false;
+    
+    std::wstring exe7z = Get7zExePath();
+    if (exe7z.empty())
+    {
+        LOG_ERROR(L"7z.exe not found!");
+        if (callback) 
+        {
+            callback->OnError(ErrorCode::ExtractionFailed, L"7z.exe is missing. Cannot create archive.");
+        }
+        return;
+    }
     
-    // Command: 7z.exe a -t<format> "Destination" @listfile
-    std::wstringstream cmd;
-    cmd << L"\"" << exe7z << L"\" a -t" << (format.empty() ? L"zip" : format.substr(1)) << L" \"" << destinationPath << L"\" \"@" << listFileName << L"\"";
+    // Create temporary file list
+    // 7-Zip supports list files with @listfile
+    std::wstring listFileName = WriteListFile(sourceFiles);
+    if (listFileName.empty())
+    {
+        if (callback) callback->OnError(ErrorCode::UnknownError, L"Failed to create temporary list file");
+        return;
+    }
     
-    if (callback) callback->OnStart(static_cast<int>(sourceFiles.size()));
+    // Command: 7z.exe a -t<format> "Destination" @listfile plus the method and progress switches
+    std::vector<std::wstring> arguments = { L"a", L"-t" + (format.empty() ? std::wstring(L"zip") : format.substr(1)),
+                                            destinationPath, L"@" + listFileName };
+    std::vector<std::wstring> methodSwitches = profile.ToArguments();
+    arguments.insert(arguments.end(), methodSwitches.begin(), methodSwitches.end());
+    arguments.insert(arguments.end(), std::begin(PROGRESS_SWITCHES), std::end(PROGRESS_SWITCHES));
     
-    LOG_INFO(L"Launching 7-Zip Creation: " + cmd.str());
+    if (callback) callback->OnStart(static_cast<int>(sourceFiles.size()));
     
-    STARTUPINFOW si = { sizeof(si) };
-    PROCESS_INFORMATION pi = { 0 };
+    int exitCode = 0;
+    std::wstring message;
+    RunResult result = Run7z(exe7z, arguments, 0, static_cast<int>(sourceFiles.size()), 0, 0, callback, exitCode, message);
     
-    std::wstring cmdStr = cmd.str();
-    std::vector<wchar_t> cmdVec(cmdStr.begin(), cmdStr.end());
-    cmdVec.push_back(0);
+    // Cleanup list file
+    DeleteFileW(listFileName.c_str());
     
-    if (CreateProcessW(NULL, cmdVec.data(), NULL, NULL, FALSE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi))
+    switch (result)
     {
-        m_hSubProcess = pi.hProcess;
-        CloseHandle(pi.hThread);
-        
-        while (true)
-        {
-            DWORD waitResult = WaitForSingleObject(pi.hProcess, 100);
-            if (waitResult == WAIT_OBJECT_0) break;
-            
-            if (m_cancelled)
-            {
-                TerminateProcess(pi.hProcess, 1);
-                break;
-            }
-        }
-        
-        DWORD exitCode = 0;
-        GetExitCodeProcess(pi.hProcess, &exitCode);
-        CloseHandle(pi.hProcess);
-        m_hSubProcess = nullptr;
-        
-        // Cleanup list file
-        DeleteFileW(listFileName);
-        
-        if (m_cancelled)
-        {
-             if (callback) callback->OnError(ErrorCode::CancellationRequested, L"Cancelled");
-             return;
-        }
-        
+    case RunResult::LaunchFailed:
+        LOG_ERROR(L"Failed to start 7z.exe (Create): " + message);
+        if (callback) callback->OnError(ErrorCode::UnknownError, L"Failed to launch 7z.exe (Create)");
+        break;
+    case RunResult::Stalled: // No limits for creation
+    case RunResult::DeadlineExceeded:
+    case RunResult::Cancelled:
+        if (callback) callback->OnError(ErrorCode::CancellationRequested, L"Cancelled");
+        break;
+    case RunResult::Finished:
         if (exitCode == 0)
         {
-             if (callback) callback->OnComplete(destinationPath);
+            if (callback) callback->OnComplete(destinationPath);
         }
         else
         {
-             if (callback) callback->OnError(ErrorCode::ExtractionFailed, L"7-Zip Error Code: " + std::to_wstring(exitCode));
+            if (callback)
+            {
+                callback->OnError(ErrorCode::ExtractionFailed,
+                    message.empty() ? L"7-Zip Error Code: " + std::to_wstring(exitCode) : message);
+            }
         }
-    }
-    else
-    {
-        DeleteFileW(listFileName);
-        DWORD err = GetLastError();
-        if (callback) callback->OnError(ErrorCode::UnknownError, L"Failed to launch 7z.exe (Create)");
+        break;
     }
 }
 
 void SevenZipEngine::Cancel()
 {
     m_cancelled = true;
-    // Termination handling is in the loop in Extract
+    // Termination handling is in the read loop in Run7z
 }
 
 } // namespace ZipSpark
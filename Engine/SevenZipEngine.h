@@ -2,12 +2,14 @@
 #include "IExtractionEngine.h"
 #include <string>
 #include <atomic>
+#include <vector>
 
 namespace ZipSpark {
 
 /// <summary>
 /// Robust Extraction Engine that runs 7z.exe as a subprocess.
 /// Provides process isolation so crashes in 7-Zip do not affect the main app.
+/// Progress is parsed live from 7z's console output (-bsp1 -bso1).
 /// </summary>
 class SevenZipEngine : public IExtractionEngine
 {
@@ -18,18 +20,65 @@ public:
     bool CanHandle(const std::wstring& archivePath) override;
     ArchiveInfo GetArchiveInfo(const std::wstring& archivePath) override;
     void Extract(const ArchiveInfo& info, const ExtractionOptions& options, IProgressCallback* callback) override;
-    void CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>& sourceFiles, const std::wstring& format, IProgressCallback* callback) override;
+    void CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>& sourceFiles, const std::wstring& format, const CompressionProfile& profile, IProgressCallback* callback) override;
     void Cancel() override;
     std::wstring GetEngineName() const override { return L"7-Zip (Process)"; }
+
+    // Whether 7z.exe was found (without it, listing falls back to an in-process scan)
+    bool IsAvailable() { return !Get7zExePath().empty(); }
     
 private:
     std::atomic<bool> m_cancelled{false};
-    void* m_hSubProcess = nullptr; // HANDLE to the process
+    std::atomic<bool> m_abortShards{false};  // One shard failed: stop the others
+
+    enum class RunResult
+    {
+        Finished,          // exitCode is valid
+        LaunchFailed,      // message says why
+        Stalled,           // No progress for stallTimeoutMs
+        DeadlineExceeded,  // Ran longer than deadlineMs
+        Cancelled
+    };
+
+    // Run 7z with the given arguments, forwarding its progress to callback.
+    // 7z is stopped once it makes no progress for stallTimeoutMs or runs past
+    // deadlineMs (0 disables either). For a failed run, message is 7-Zip's own
+    // error line when it printed one.
+    RunResult Run7z(const std::wstring& exe7z, const std::vector<std::wstring>& arguments, uint64_t totalBytes,
+                    int totalFiles, uint32_t stallTimeoutMs, uint32_t deadlineMs, IProgressCallback* callback,
+                    int& exitCode, std::wstring& message);
+
+    struct Shard
+    {
+        std::vector<std::wstring> paths;
+        uint64_t bytes = 0;
+    };
+
+    // Split the selected files of a non-solid archive into size-balanced
+    // shards for parallel 7z processes. False when a single process is the
+    // better choice (solid or small archive, no index, one core).
+    bool PlanShards(const ArchiveInfo& info, const ExtractionOptions& options, std::vector<Shard>& shards,
+                    std::vector<std::wstring>& directories) const;
+
+    // Run one 7z per shard (arguments plus the shard's @listfile), merging
+    // their progress into callback. The first failing shard stops the rest
+    // and decides the result.
+    RunResult RunShards(const std::wstring& exe7z, const std::vector<std::wstring>& arguments,
+                        const std::vector<Shard>& shards, uint64_t totalBytes, int totalFiles,
+                        const ExtractionOptions& options, IProgressCallback* callback, int& exitCode,
+                        std::wstring& message);
+
+    // Fill info from 7z l -slt: totals plus the entry table with packed sizes,
+    // CRCs, attributes and solid blocks. False if 7-Zip can't list the archive.
+    bool ListArchive(const std::wstring& exe7z, const std::wstring& archivePath, ArchiveInfo& info);
 
     // Helpers
     std::wstring DetermineDestination(const ArchiveInfo& info, const ExtractionOptions& options);
     std::wstring Get7zExePath();
     bool IsSupportedFormat(const std::wstring& extension);
+
+    // Write paths to a temporary UTF-8 @listfile; returns its path or empty on failure
+    std::wstring WriteListFile(const std::vector<std::wstring>& paths);
 };
 
 } // namespace ZipSpark
@@ -0,0 +1,255 @@
+#include "SevenZipListParser.h"
+#include "SevenZipText.h"
+#include <cstring>
+
+namespace ZipSpark {
+
+static bool ParseHex(std::string_view text, uint32_t& value)
+{
+    if (text.empty() || text.size() > 8)
+    {
+        return false;
+    }
+    value = 0;
+    for (char c : text)
+    {
+        uint32_t digit;
+        if (c >= '0' && c <= '9') digit = static_cast<uint32_t>(c - '0');
+        else if (c >= 'A' && c <= 'F') digit = static_cast<uint32_t>(c - 'A' + 10);
+        else if (c >= 'a' && c <= 'f') digit = static_cast<uint32_t>(c - 'a' + 10);
+        else return false;
+        value = (value << 4) | digit;
+    }
+    return true;
+}
+
+// Fixed-width field of a timestamp
+static bool ParseDigits(std::string_view text, size_t offset, size_t count, int64_t& value)
+{
+    if (offset + count > text.size())
+    {
+        return false;
+    }
+    value = 0;
+    for (size_t i = offset; i < offset + count; i++)
+    {
+        if (text[i] < '0' || text[i] > '9')
+        {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+// "2024-01-31 12:34:56[.fraction]" to seconds since 1970 (days-from-civil)
+static bool ParseTime(std::string_view text, int64_t& seconds)
+{
+    int64_t year, month, day, hour, minute, second;
+    if (!ParseDigits(text, 0, 4, year) || !ParseDigits(text, 5, 2, month) || !ParseDigits(text, 8, 2, day) ||
+        !ParseDigits(text, 11, 2, hour) || !ParseDigits(text, 14, 2, minute) || !ParseDigits(text, 17, 2, second))
+    {
+        return false;
+    }
+
+    year -= month <= 2 ? 1 : 0;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int64_t days = era * 146097 + dayOfEra - 719468;
+
+    seconds = days * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+// "DA", "A -rw-r--r--": one letter per FILE_ATTRIBUTE_* bit, in bit order
+static uint32_t ParseAttributes(std::string_view text)
+{
+    static const char ATTRIBUTE_CHARS[] = "RHS8DAdNTsLCOIEV";
+
+    uint32_t attributes = 0;
+    for (char c : text)
+    {
+        if (c == ' ')
+        {
+            break; // Unix mode follows
+        }
+        if (const char* bit = static_cast<const char*>(memchr(ATTRIBUTE_CHARS, c, sizeof(ATTRIBUTE_CHARS) - 1)))
+        {
+            attributes |= 1u << (bit - ATTRIBUTE_CHARS);
+        }
+    }
+    return attributes;
+}
+
+void SevenZipListParser::Feed(const char* data, size_t size)
+{
+    while (size > 0)
+    {
+        const char* newline = static_cast<const char*>(memchr(data, '\n', size));
+        if (!newline)
+        {
+            m_partial.append(data, size);
+            return;
+        }
+
+        size_t length = static_cast<size_t>(newline - data);
+        if (m_partial.empty())
+        {
+            // The usual case: the whole line is in this chunk
+            ParseLine(std::string_view(data, length));
+        }
+        else
+        {
+            m_partial.append(data, length);
+            ParseLine(m_partial);
+            m_partial.clear();
+        }
+
+        data += length + 1;
+        size -= length + 1;
+    }
+}
+
+void SevenZipListParser::Finish()
+{
+    if (!m_partial.empty())
+    {
+        ParseLine(m_partial);
+        m_partial.clear();
+    }
+    EndEntry();
+}
+
+void SevenZipListParser::ParseLine(std::string_view line)
+{
+    line = SevenZipText::Trim(line);
+
+    if (line.empty())
+    {
+        EndEntry();
+        return;
+    }
+
+    // Section markers
+    if (line == "--" && m_state == State::Preamble)
+    {
+        m_state = State::Archive;
+        return;
+    }
+    if (line == "----------" && m_state == State::Archive)
+    {
+        m_state = State::Entries;
+        return;
+    }
+
+    size_t equals = line.find(" = ");
+    if (m_state == State::Preamble || equals == std::string_view::npos)
+    {
+        // "CRC =" with nothing after it still is a property
+        if (m_state != State::Preamble && line.size() >= 2 && line.substr(line.size() - 2) == " =")
+        {
+            equals = line.size() - 2;
+        }
+        else
+        {
+            m_listener.OnLine(line);
+            return;
+        }
+    }
+
+    std::string_view key = line.substr(0, equals);
+    std::string_view value = equals + 3 <= line.size() ? line.substr(equals + 3) : std::string_view();
+
+    if (m_state == State::Archive)
+    {
+        ParseArchiveProperty(key, value);
+    }
+    else
+    {
+        ParseEntryProperty(key, value);
+    }
+}
+
+void SevenZipListParser::ParseArchiveProperty(std::string_view key, std::string_view value)
+{
+    uint64_t number = 0;
+    if (key == "Solid")
+    {
+        m_archive.isSolid = value == "+";
+    }
+    else if (key == "Blocks" && SevenZipText::ParseNumber(value, number))
+    {
+        m_archive.blockCount = static_cast<uint32_t>(number);
+    }
+    else if (key == "Physical Size" && SevenZipText::ParseNumber(value, number))
+    {
+        m_archive.physicalSize = number;
+    }
+}
+
+void SevenZipListParser::ParseEntryProperty(std::string_view key, std::string_view value)
+{
+    // Every entry block starts with its path
+    if (key == "Path")
+    {
+        EndEntry();
+        m_path.assign(value.data(), value.size());
+        m_entry = Entry();
+        m_inEntry = true;
+        return;
+    }
+    if (!m_inEntry)
+    {
+        return;
+    }
+
+    uint64_t number = 0;
+    if (key == "Size")
+    {
+        if (SevenZipText::ParseNumber(value, number)) m_entry.size = number;
+    }
+    else if (key == "Packed Size")
+    {
+        if (SevenZipText::ParseNumber(value, number)) m_entry.packedSize = number;
+    }
+    else if (key == "Modified")
+    {
+        ParseTime(value, m_entry.modifiedTime);
+    }
+    else if (key == "Attributes")
+    {
+        m_entry.attributes = ParseAttributes(value);
+        m_entry.isDirectory = m_entry.isDirectory || (m_entry.attributes & 0x10) != 0;
+    }
+    else if (key == "Folder")
+    {
+        m_entry.isDirectory = m_entry.isDirectory || value == "+";
+    }
+    else if (key == "CRC")
+    {
+        ParseHex(value, m_entry.crc);
+    }
+    else if (key == "Encrypted")
+    {
+        m_entry.isEncrypted = value == "+";
+    }
+    else if (key == "Block")
+    {
+        if (SevenZipText::ParseNumber(value, number)) m_entry.block = static_cast<uint32_t>(number);
+    }
+}
+
+void SevenZipListParser::EndEntry()
+{
+    if (!m_inEntry)
+    {
+        return;
+    }
+    m_inEntry = false;
+    m_entry.path = m_path;
+    m_listener.OnEntry(m_entry);
+}
+
+} // namespace ZipSpark
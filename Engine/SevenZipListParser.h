@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Streaming parser for the technical listing of 7z l -slt: a block of
+/// "Key = Value" lines describing the archive, then one block per entry,
+/// blocks separated by blank lines. Lines are parsed in place in the chunk
+/// they arrived in; only a line split across two chunks and the path of the
+/// entry being read are copied (into buffers reused for every line), so a
+/// million-entry listing costs no allocation per line. Entries are reported
+/// as they complete. Views handed to the listener are only valid during the call.
+/// </summary>
+class SevenZipListParser
+{
+public:
+    static constexpr uint32_t NO_BLOCK = 0xFFFFFFFF;
+
+    struct Entry
+    {
+        std::string_view path;
+        uint64_t size = 0;
+        uint64_t packedSize = 0;      // 0 when 7-Zip does not know it (solid blocks, stored per block)
+        int64_t modifiedTime = 0;     // Seconds since 1970 of the time as printed (7-Zip prints local time)
+        uint32_t crc = 0;             // 0 if not listed
+        uint32_t attributes = 0;      // Windows FILE_ATTRIBUTE_* bits, 0 if not listed
+        uint32_t block = NO_BLOCK;    // Solid block index, NO_BLOCK if not listed
+        bool isDirectory = false;
+        bool isEncrypted = false;
+    };
+
+    struct ArchiveProperties
+    {
+        bool isSolid = false;
+        uint32_t blockCount = 0;
+        uint64_t physicalSize = 0;
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        virtual void OnEntry(const Entry& entry) = 0;
+        // Any line that is not part of the listing (banner, warnings, errors), trimmed
+        virtual void OnLine(std::string_view /*line*/) {}
+    };
+
+    explicit SevenZipListParser(Listener& listener) : m_listener(listener) {}
+
+    void Feed(const char* data, size_t size);
+
+    // End of output: report a final unterminated line and entry
+    void Finish();
+
+    // Whether the listing reached the entry blocks
+    bool SawEntries() const { return m_state == State::Entries; }
+
+    const ArchiveProperties& GetArchiveProperties() const { return m_archive; }
+
+private:
+    enum class State
+    {
+        Preamble,  // Banner up to the "--" line
+        Archive,   // Archive properties up to the "----------" line
+        Entries
+    };
+
+    void ParseLine(std::string_view line);
+    void ParseArchiveProperty(std::string_view key, std::string_view value);
+    void ParseEntryProperty(std::string_view key, std::string_view value);
+    void EndEntry();
+
+    Listener& m_listener;
+    State m_state = State::Preamble;
+    ArchiveProperties m_archive;
+
+    std::string m_partial;  // Start of a line split across chunks
+    std::string m_path;     // Path of the entry being read
+    Entry m_entry;
+    bool m_inEntry = false;
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,155 @@
+#include "SevenZipOutputParser.h"
+#include "SevenZipText.h"
+
+namespace ZipSpark {
+
+// Split off the next space-delimited token
+static std::string_view NextToken(std::string_view& text)
+{
+    size_t end = text.find(' ');
+    std::string_view token = text.substr(0, end);
+    text = end == std::string_view::npos ? std::string_view() : SevenZipText::Trim(text.substr(end));
+    return token;
+}
+
+// "1234", "56K", "78M": 7-Zip's compact sizes (binary units)
+static bool ParseSize(std::string_view text, uint64_t& value)
+{
+    if (text.empty())
+    {
+        return false;
+    }
+    unsigned shift = 0;
+    switch (text.back())
+    {
+    case 'K': shift = 10; break;
+    case 'M': shift = 20; break;
+    case 'G': shift = 30; break;
+    case 'T': shift = 40; break;
+    default: break;
+    }
+    if (shift != 0)
+    {
+        text.remove_suffix(1);
+    }
+    if (!SevenZipText::ParseNumber(text, value))
+    {
+        return false;
+    }
+    value <<= shift;
+    return true;
+}
+
+void SevenZipOutputParser::Feed(const char* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        char c = data[i];
+
+        // Backspaces erase the redrawn progress line; treat them like line ends
+        if (c == '\n' || c == '\r' || c == '\b')
+        {
+            EndLine();
+            continue;
+        }
+
+        // The tail of an overlong line is dropped
+        if (m_length < MAX_LINE)
+        {
+            m_line[m_length++] = c;
+        }
+    }
+}
+
+void SevenZipOutputParser::Finish()
+{
+    EndLine();
+}
+
+void SevenZipOutputParser::EndLine()
+{
+    std::string_view line = SevenZipText::Trim(std::string_view(m_line, m_length));
+    m_length = 0;
+
+    if (line.empty())
+    {
+        return;
+    }
+
+    Progress progress;
+    if (ParseProgress(line, progress))
+    {
+        m_listener.OnProgress(progress);
+    }
+    else
+    {
+        m_listener.OnLine(line);
+    }
+}
+
+bool SevenZipOutputParser::ParseProgress(std::string_view line, Progress& progress) const
+{
+    // "<percent>%" or "<size>", then [files] [command] [file name]
+    std::string_view rest = line;
+    std::string_view head = NextToken(rest);
+
+    uint64_t value = 0;
+    if (head.size() >= 2 && head.back() == '%')
+    {
+        if (!SevenZipText::ParseNumber(head.substr(0, head.size() - 1), value) || value > 100)
+        {
+            return false;
+        }
+        progress.percent = static_cast<int>(value);
+    }
+    else if (ParseSize(head, value))
+    {
+        // Only taken for progress when a command follows (checked below):
+        // "3 files, 1234 bytes" from the scan summary starts with a number too
+        progress.bytes = value;
+    }
+    else
+    {
+        return false;
+    }
+
+    std::string_view saved = rest;
+    std::string_view token = NextToken(rest);
+    if (SevenZipText::ParseNumber(token, value))
+    {
+        progress.files = value;
+    }
+    else
+    {
+        rest = saved;
+    }
+
+    // The command is a single character; the file name is everything after it
+    saved = rest;
+    token = NextToken(rest);
+    if (token.size() == 1)
+    {
+        progress.command = token;
+        progress.file = rest;
+    }
+    else if (progress.percent < 0)
+    {
+        return false;
+    }
+    else
+    {
+        progress.file = saved;
+    }
+    return true;
+}
+
+bool SevenZipOutputParser::ParseSummary(std::string_view line, std::string_view key, uint64_t& value)
+{
+    if (line.size() <= key.size() || line.substr(0, key.size()) != key || line[key.size()] != ':')
+    {
+        return false;
+    }
+    return SevenZipText::ParseNumber(SevenZipText::Trim(line.substr(key.size() + 1)), value);
+}
+
+} // namespace ZipSpark
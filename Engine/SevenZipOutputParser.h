@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Streaming parser for the console output of 7z run with -bsp1 -bso1.
+/// 7-Zip redraws its progress line in place: "  42% 17 - dir\file.txt", then
+/// backspaces over it and prints the next state. Progress lines are reported
+/// as structured values, and every other line (headers, summary, errors) is
+/// passed through as text. Bytes can arrive in arbitrary chunks. The parser
+/// keeps one fixed line buffer and never allocates. Views handed to the
+/// listener are only valid during the call.
+/// </summary>
+class SevenZipOutputParser
+{
+public:
+    struct Progress
+    {
+        int percent = -1;           // -1 when 7-Zip shows a byte count instead
+        uint64_t bytes = 0;         // Completed bytes, when shown
+        uint64_t files = 0;         // Items finished so far
+        std::string_view command;   // "-" extract, "+" add, "U" update, ...
+        std::string_view file;      // Item being processed (empty if none)
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        virtual void OnProgress(const Progress& progress) = 0;
+        // Any other non-empty output line, trimmed
+        virtual void OnLine(std::string_view line) = 0;
+    };
+
+    explicit SevenZipOutputParser(Listener& listener) : m_listener(listener) {}
+
+    void Feed(const char* data, size_t size);
+
+    // End of output: report a final unterminated line
+    void Finish();
+
+    // Value of a summary line such as "Size: 12345" or "Files: 17"
+    static bool ParseSummary(std::string_view line, std::string_view key, uint64_t& value);
+
+private:
+    static constexpr size_t MAX_LINE = 2048;
+
+    void EndLine();
+    bool ParseProgress(std::string_view line, Progress& progress) const;
+
+    Listener& m_listener;
+    char m_line[MAX_LINE];
+    size_t m_length = 0;
+};
+
+} // namespace ZipSpark
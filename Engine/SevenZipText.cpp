@@ -0,0 +1,38 @@
+#include "SevenZipText.h"
+
+namespace ZipSpark {
+
+std::string_view SevenZipText::Trim(std::string_view text)
+{
+    size_t begin = 0;
+    while (begin < text.size() && (text[begin] == ' ' || text[begin] == '\t'))
+    {
+        begin++;
+    }
+    size_t end = text.size();
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r'))
+    {
+        end--;
+    }
+    return text.substr(begin, end - begin);
+}
+
+bool SevenZipText::ParseNumber(std::string_view text, uint64_t& value)
+{
+    if (text.empty())
+    {
+        return false;
+    }
+    value = 0;
+    for (char c : text)
+    {
+        if (c < '0' || c > '9')
+        {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return true;
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Field helpers shared by the parsers of 7-Zip's console output
+/// (SevenZipOutputParser, SevenZipListParser). Portable (no Win32 dependency).
+/// </summary>
+class SevenZipText
+{
+public:
+    // Without leading and trailing spaces, tabs and carriage returns
+    static std::string_view Trim(std::string_view text);
+
+    // Plain decimal digits only; false for anything else or an empty field
+    static bool ParseNumber(std::string_view text, uint64_t& value);
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,47 @@
+#include "StallWatchdog.h"
+
+namespace ZipSpark {
+
+StallWatchdog::StallWatchdog(uint32_t stallTimeoutMs, uint32_t deadlineMs)
+    : m_stallTimeoutMs(stallTimeoutMs), m_deadlineMs(deadlineMs), m_start(Clock::now()), m_lastProgress(m_start)
+{
+}
+
+void StallWatchdog::Observe(uint64_t position)
+{
+    if (position > m_position)
+    {
+        m_position = position;
+        m_lastProgress = Clock::now();
+    }
+}
+
+void StallWatchdog::Advance()
+{
+    m_lastProgress = Clock::now();
+}
+
+StallWatchdog::Verdict StallWatchdog::Check() const
+{
+    if (m_deadlineMs != 0 && GetElapsedMs() > m_deadlineMs)
+    {
+        return Verdict::DeadlineExceeded;
+    }
+    if (m_stallTimeoutMs != 0 && GetIdleMs() > m_stallTimeoutMs)
+    {
+        return Verdict::Stalled;
+    }
+    return Verdict::Running;
+}
+
+uint64_t StallWatchdog::GetIdleMs() const
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_lastProgress).count());
+}
+
+uint64_t StallWatchdog::GetElapsedMs() const
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_start).count());
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Decides when to give up on a helper process (7z.exe or an extraction
+/// worker). Every sign of forward progress restarts the stall window, so a
+/// long job that keeps moving is never cut off, however large the archive;
+/// only one that goes quiet for the whole window is. An overall deadline is
+/// opt-in. The caller feeds observations and polls Check from its read loop.
+/// Portable (no Win32 dependency).
+/// </summary>
+class StallWatchdog
+{
+public:
+    enum class Verdict
+    {
+        Running,
+        Stalled,           // No forward progress for the stall window
+        DeadlineExceeded   // Ran longer than the deadline
+    };
+
+    // Limits in milliseconds; 0 disables either one
+    StallWatchdog(uint32_t stallTimeoutMs, uint32_t deadlineMs);
+
+    // A monotonic measure of work done (bytes, items); any increase is progress
+    void Observe(uint64_t position);
+
+    // One progress event (a new file started, the job started)
+    void Advance();
+
+    Verdict Check() const;
+
+    // Time since the last forward progress / since the start
+    uint64_t GetIdleMs() const;
+    uint64_t GetElapsedMs() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    uint32_t m_stallTimeoutMs;
+    uint32_t m_deadlineMs;
+    Clock::time_point m_start;
+    Clock::time_point m_lastProgress;
+    uint64_t m_position = 0;
+};
+
+} // namespace ZipSpark
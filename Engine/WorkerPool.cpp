@@ -0,0 +1,308 @@
+#include "pch.h"
+#include "WorkerPool.h"
+#include "StallWatchdog.h"
+#include "WorkerProtocol.h"
+#include "../Utils/ErrorHandler.h"
+#include "../Utils/Logger.h"
+#include <cwchar>
+
+namespace ZipSpark {
+
+static uint64_t ToNumber(const std::wstring& field)
+{
+    return std::wcstoull(field.c_str(), nullptr, 10);
+}
+
+// Failures that are libarchive's limits rather than the archive's or the
+// destination's: another engine may still extract it
+static bool IsUnsupported(ErrorCode code)
+{
+    return code == ErrorCode::UnsupportedFormat || code == ErrorCode::PasswordRequired;
+}
+
+std::unique_ptr<WorkerPool::Worker> WorkerPool::Launch(std::wstring& error)
+{
+    wchar_t exePath[MAX_PATH];
+    GetModuleFileNameW(NULL, exePath, MAX_PATH);
+
+    auto worker = std::make_unique<Worker>();
+    if (!worker->process.Start(exePath, { WorkerProtocol::WORKER_SWITCH }, error, true))
+    {
+        LOG_ERROR(L"Failed to start extraction worker: " + error);
+        return nullptr;
+    }
+    LOG_INFO(L"Extraction worker launched");
+    return worker;
+}
+
+std::unique_ptr<WorkerPool::Worker> WorkerPool::Acquire(std::wstring& error)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle.empty())
+        {
+            std::unique_ptr<Worker> worker = std::move(m_idle.back());
+            m_idle.pop_back();
+            return worker;
+        }
+    }
+    return Launch(error);
+}
+
+void WorkerPool::Release(std::unique_ptr<Worker> worker)
+{
+    worker->output.clear();
+    worker->consumed = 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (worker->jobs < MAX_JOBS_PER_WORKER && m_idle.size() < MAX_IDLE_WORKERS)
+    {
+        m_idle.push_back(std::move(worker));
+    }
+    // Otherwise it is retired here; an idle worker is safe to stop
+}
+
+std::unique_ptr<WorkerPool::Worker> WorkerPool::Send(const std::string& request, std::wstring& error)
+{
+    std::unique_ptr<Worker> worker = Acquire(error);
+    if (worker && !worker->process.WriteInput(request.data(), request.size()))
+    {
+        // Idle workers can exit between jobs; a fresh one gets a second try
+        LOG_WARNING(L"Idle extraction worker is gone, launching another");
+        worker = Launch(error);
+        if (worker && !worker->process.WriteInput(request.data(), request.size()))
+        {
+            error = L"The extraction worker did not accept the request";
+            worker.reset();
+        }
+    }
+    return worker;
+}
+
+void WorkerPool::Prewarm(size_t count)
+{
+    count = std::min(count, MAX_IDLE_WORKERS);
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_idle.size() >= count)
+            {
+                return;
+            }
+        }
+
+        std::wstring error;
+        std::unique_ptr<Worker> worker = Launch(error);
+        if (!worker)
+        {
+            return;
+        }
+        Release(std::move(worker));
+    }
+}
+
+WorkerPool::JobResult WorkerPool::Extract(const std::wstring& archivePath, const std::wstring& destination,
+                                          OverwritePolicy policy, const ExtractionOptions& options,
+                                          IProgressCallback* callback, const std::atomic<bool>& cancelled,
+                                          std::wstring& message, ErrorCode& errorCode)
+{
+    std::string request;
+    // Everything the engine reads from the options except memoryTarget (the
+    // caller's memory, which the engine keeps in this process) and the
+    // watchdog limits, which are applied here
+    WorkerProtocol::AppendMessage(request,
+        { L"EXTRACT", archivePath, destination, std::to_wstring(static_cast<int>(policy)),
+          options.preserveTimestamps ? L"1" : L"0", options.preservePermissions ? L"1" : L"0",
+          std::to_wstring(options.threadCount), std::to_wstring(options.bufferSize),
+          std::to_wstring(options.writeBufferSize), std::to_wstring(options.unbufferedWriteThreshold),
+          std::to_wstring(options.pipelineMemoryLimit), std::to_wstring(static_cast<int>(options.writeBackend)),
+          std::to_wstring(options.memoryMapLimit), options.cacheToMemory ? L"1" : L"0",
+          std::to_wstring(options.memoryBudget) },
+        options.selection);
+
+    errorCode = ErrorCode::ExtractionFailed;
+    std::unique_ptr<Worker> worker = Send(request, message);
+    if (!worker)
+    {
+        return JobResult::NotStarted;
+    }
+    worker->jobs++;
+
+    bool started = false;
+    StallWatchdog watchdog(options.stallTimeoutMs, options.deadlineMs);
+    std::vector<std::wstring> fields;
+    char buffer[4096];
+
+    // The read timeout lets cancellation and the watchdog be checked while
+    // the worker is silent
+    while (true)
+    {
+        std::string_view line;
+        while (WorkerProtocol::NextLine(worker->output, worker->consumed, line))
+        {
+            WorkerProtocol::Split(line, fields);
+            const std::wstring& type = fields[0];
+
+            if (type == L"START" && fields.size() >= 2)
+            {
+                started = true;
+                watchdog.Advance();
+                if (callback) callback->OnStart(static_cast<int>(ToNumber(fields[1])));
+            }
+            else if (type == L"PROGRESS" && fields.size() >= 4)
+            {
+                watchdog.Observe(ToNumber(fields[2]));
+                if (callback) callback->OnProgress(static_cast<int>(ToNumber(fields[1])), ToNumber(fields[2]), ToNumber(fields[3]));
+            }
+            else if (type == L"FILE" && fields.size() >= 4)
+            {
+                watchdog.Advance();
+                if (callback) callback->OnFileProgress(fields[3], static_cast<int>(ToNumber(fields[1])), static_cast<int>(ToNumber(fields[2])));
+            }
+            else if (type == L"COMPLETE" && fields.size() >= 2)
+            {
+                if (callback) callback->OnComplete(fields[1]);
+                Release(std::move(worker));
+                return JobResult::Completed;
+            }
+            else if (type == L"ERROR" && fields.size() >= 3)
+            {
+                // What libarchive can't read goes back to the caller, which may
+                // try another engine; any other refusal (no disk space, a
+                // damaged archive) is the answer
+                errorCode = static_cast<ErrorCode>(ToNumber(fields[1]));
+                message = fields[2];
+                Release(std::move(worker));
+                if (IsUnsupported(errorCode))
+                {
+                    return started ? JobResult::Unsupported : JobResult::NotStarted;
+                }
+                if (callback) callback->OnError(errorCode, message);
+                return JobResult::Failed;
+            }
+        }
+
+        if (cancelled)
+        {
+            LOG_INFO(L"Stopping extraction worker due to user cancellation...");
+            worker->process.Terminate();
+            worker->process.Wait();
+            return JobResult::Cancelled;
+        }
+
+        StallWatchdog::Verdict verdict = watchdog.Check();
+        if (verdict != StallWatchdog::Verdict::Running)
+        {
+            bool stalled = verdict == StallWatchdog::Verdict::Stalled;
+            LOG_ERROR(stalled ?
+                L"Extraction worker made no progress for " + std::to_wstring(watchdog.GetIdleMs()) + L"ms" :
+                L"Extraction worker passed its deadline after " + std::to_wstring(watchdog.GetElapsedMs()) + L"ms");
+            worker->process.Terminate();
+            worker->process.Wait();
+
+            message = stalled ?
+                L"Extraction stopped making progress for " + std::to_wstring(options.stallTimeoutMs / 1000) + L" seconds.\n\n"
+                L"The archive may be corrupted, or the disk is not responding." :
+                L"Extraction did not finish within the configured limit of " + std::to_wstring(options.deadlineMs / 1000) + L" seconds.";
+            if (stalled && !started)
+            {
+                return JobResult::NotStarted;
+            }
+            if (callback) callback->OnError(ErrorCode::ExtractionFailed, message);
+            return JobResult::Failed;
+        }
+
+        size_t bytesRead = 0;
+        ChildProcess::ReadResult read = worker->process.Read(buffer, sizeof(buffer), 100, bytesRead);
+        if (read == ChildProcess::ReadResult::End)
+        {
+            break;
+        }
+        if (read == ChildProcess::ReadResult::Data)
+        {
+            worker->output.append(buffer, bytesRead);
+        }
+    }
+
+    // Output ended without a result: the worker crashed (it is not reused)
+    int exitCode = worker->process.Wait();
+    LOG_ERROR(L"Extraction worker exited unexpectedly with code " + std::to_wstring(exitCode));
+    message = L"The extraction process stopped unexpectedly. The archive may be corrupt or incompatible.";
+    if (!started)
+    {
+        return JobResult::NotStarted;
+    }
+    if (callback) callback->OnError(ErrorCode::ExtractionFailed, message);
+    return JobResult::Failed;
+}
+
+bool WorkerPool::Scan(const std::wstring& archivePath, ArchiveInfo& info, std::wstring& message)
+{
+    std::string request;
+    WorkerProtocol::AppendMessage(request, { L"SCAN", archivePath });
+
+    std::unique_ptr<Worker> worker = Send(request, message);
+    if (!worker)
+    {
+        return false;
+    }
+    worker->jobs++;
+
+    // No progress is reported; a scan that takes this long is stuck
+    StallWatchdog watchdog(SCAN_TIMEOUT_MS, 0);
+    std::vector<std::wstring> fields;
+    char buffer[4096];
+
+    while (true)
+    {
+        std::string_view line;
+        while (WorkerProtocol::NextLine(worker->output, worker->consumed, line))
+        {
+            WorkerProtocol::Split(line, fields);
+            if (fields[0] == L"SCANNED" && fields.size() >= 7)
+            {
+                Release(std::move(worker));
+                info.isEncrypted = info.isEncrypted || fields[5] == L"1";
+                info.hasSingleRoot = fields[6] == L"1";
+                if (fields[1] != L"1")
+                {
+                    message = L"The archive's headers could not all be read without decoding it";
+                    return false;
+                }
+                info.fileCount = static_cast<uint32_t>(ToNumber(fields[2]));
+                info.directoryCount = static_cast<uint32_t>(ToNumber(fields[3]));
+                info.totalSize = ToNumber(fields[4]);
+                return true;
+            }
+        }
+
+        if (watchdog.Check() != StallWatchdog::Verdict::Running)
+        {
+            LOG_ERROR(L"Extraction worker did not finish a header scan in " + std::to_wstring(watchdog.GetElapsedMs()) + L"ms");
+            worker->process.Terminate();
+            worker->process.Wait();
+            message = L"The header scan did not finish";
+            return false;
+        }
+
+        size_t bytesRead = 0;
+        ChildProcess::ReadResult read = worker->process.Read(buffer, sizeof(buffer), 100, bytesRead);
+        if (read == ChildProcess::ReadResult::End)
+        {
+            break;
+        }
+        if (read == ChildProcess::ReadResult::Data)
+        {
+            worker->output.append(buffer, bytesRead);
+        }
+    }
+
+    // The scan took the worker down (it is not reused)
+    int exitCode = worker->process.Wait();
+    LOG_ERROR(L"Extraction worker exited during a header scan with code " + std::to_wstring(exitCode));
+    message = L"The header scan stopped unexpectedly";
+    return false;
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,90 @@
+#pragma once
+#include "ChildProcess.h"
+#include "../Core/ArchiveInfo.h"
+#include "../Core/ExtractionOptions.h"
+#include "../Core/ExtractionProgress.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Pool of warm extraction worker processes (see ExtractionWorker). Launching
+/// a process and loading the engine costs far more than extracting a small
+/// archive, so finished workers wait for the next job instead of exiting.
+/// A worker is retired after MAX_JOBS_PER_WORKER jobs, and is never reused
+/// after a crash or a cancellation (which kills it).
+/// </summary>
+class WorkerPool
+{
+public:
+    enum class JobResult
+    {
+        Completed,   // OnComplete was forwarded
+        Failed,      // OnError was forwarded
+        Cancelled,   // Worker killed; nothing forwarded
+        NotStarted,  // No worker, or the job crashed, stalled or found the archive unreadable
+                     // before OnStart; nothing forwarded
+        Unsupported  // libarchive lacks a method or feature (or a password) the archive
+                     // needs, found after OnStart; nothing forwarded
+    };
+
+    static WorkerPool& GetInstance()
+    {
+        static WorkerPool instance;
+        return instance;
+    }
+
+    // Run one extraction on a worker, forwarding its events to callback.
+    // destination and the overwrite policy must already be resolved (not Prompt).
+    // Polls cancelled while the worker runs, and stops a worker that stalls or
+    // passes its deadline (options.stallTimeoutMs, options.deadlineMs).
+    // Errors the worker reports deliberately (no disk space, a damaged
+    // archive) are forwarded; message and errorCode say why for a job that
+    // ends as NotStarted or Unsupported.
+    JobResult Extract(const std::wstring& archivePath, const std::wstring& destination, OverwritePolicy policy,
+                      const ExtractionOptions& options, IProgressCallback* callback,
+                      const std::atomic<bool>& cancelled, std::wstring& message, ErrorCode& errorCode);
+
+    // Header scan on a worker (ArchiveScanner), so a malformed archive can't
+    // bring down the caller. Fills the totals, counts, root layout and
+    // encryption flag; the entry table is left in the index cache. Returns
+    // false if the scan was incomplete, failed or no worker answered; info
+    // then only carries isEncrypted and hasSingleRoot (from a quick scan).
+    bool Scan(const std::wstring& archivePath, ArchiveInfo& info, std::wstring& message);
+
+    // Start workers ahead of the first job
+    void Prewarm(size_t count);
+
+private:
+    WorkerPool() = default;
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    struct Worker
+    {
+        ChildProcess process;
+        uint32_t jobs = 0;
+        std::string output;     // Received bytes not yet split into lines
+        size_t consumed = 0;
+    };
+
+    std::unique_ptr<Worker> Launch(std::wstring& error);
+    std::unique_ptr<Worker> Acquire(std::wstring& error);
+    void Release(std::unique_ptr<Worker> worker);
+
+    // Hand a request to an idle or new worker; null (with error) if none took it
+    std::unique_ptr<Worker> Send(const std::string& request, std::wstring& error);
+
+    static constexpr uint32_t MAX_JOBS_PER_WORKER = 64;
+    static constexpr uint32_t SCAN_TIMEOUT_MS = 60000;
+    static constexpr size_t MAX_IDLE_WORKERS = 4;
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Worker>> m_idle;
+};
+
+} // namespace ZipSpark
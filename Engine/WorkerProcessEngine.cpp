@@ -0,0 +1,193 @@
+#include "pch.h"
+#include "WorkerProcessEngine.h"
+#include "DestinationSnapshot.h"
+#include "EngineFactory.h"
+#include "EntrySelector.h"
+#include "WorkerPool.h"
+#include "../Utils/ArchiveIndexCache.h"
+#include "../Utils/Logger.h"
+#include "../Utils/PathValidator.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace ZipSpark {
+
+WorkerProcessEngine::WorkerProcessEngine()
+{
+    // Have a worker ready by the time the header scan is done
+    WorkerPool::GetInstance().Prewarm(1);
+}
+
+WorkerProcessEngine::~WorkerProcessEngine()
+{
+}
+
+bool WorkerProcessEngine::CanHandle(const std::wstring& archivePath)
+{
+    return m_fallback.CanHandle(archivePath);
+}
+
+ArchiveInfo WorkerProcessEngine::GetArchiveInfo(const std::wstring& archivePath)
+{
+    // The workers read through libarchive, so its header scan describes what
+    // they will see. It runs in a worker too: headers are parsed there, never
+    // in this process. The entry table comes back through the index cache.
+    ArchiveInfo info;
+    info.archivePath = archivePath;
+    info.format = EngineFactory::DetectFormat(archivePath);
+
+    std::wstring message;
+    if (WorkerPool::GetInstance().Scan(archivePath, info, message))
+    {
+        info.index = ArchiveIndexCache::GetInstance().Lookup(archivePath);
+        if (!info.index)
+        {
+            LOG_WARNING(L"Entry table of the worker's header scan is not in the index cache");
+        }
+        return info;
+    }
+    LOG_INFO(L"Worker header scan incomplete (" + message + L"), listing with 7-Zip");
+
+    // 7-Zip's listing is a separate process as well; without 7z.exe the
+    // size of the file stands in, the worker's quick scan settled the root
+    // layout and extraction reports any error
+    if (m_fallback.IsAvailable())
+    {
+        ArchiveInfo listed = m_fallback.GetArchiveInfo(archivePath);
+        listed.isEncrypted = listed.isEncrypted || info.isEncrypted;
+        return listed;
+    }
+
+    std::error_code ec;
+    uintmax_t fileSize = fs::file_size(archivePath, ec);
+    info.totalSize = ec ? 0 : fileSize;
+    return info;
+}
+
+std::wstring WorkerProcessEngine::DetermineDestination(const ArchiveInfo& info, const ExtractionOptions& options)
+{
+    fs::path archivePath(info.archivePath);
+    fs::path parentDir = archivePath.parent_path();
+
+    if (!options.destinationPath.empty())
+    {
+        return options.destinationPath;
+    }
+
+    // A single root folder already keeps the contents together
+    if (info.hasSingleRoot || !options.createSubfolder)
+    {
+        return parentDir.wstring();
+    }
+
+    // Default: Extract to subfolder
+    std::wstring folderName = archivePath.stem().wstring();
+
+    // Handle .tar.gz and .tar.xz (double extension)
+    if (folderName.length() >= 4 &&
+        folderName.substr(folderName.length() - 4) == L".tar")
+    {
+        folderName = folderName.substr(0, folderName.length() - 4);
+    }
+
+    return (parentDir / folderName).wstring();
+}
+
+void WorkerProcessEngine::Extract(const ArchiveInfo& info, const ExtractionOptions& options, IProgressCallback* callback)
+{
+    m_cancelled = false;
+
+    // In-memory extraction has to happen in this process
+    if (options.cacheToMemory && options.memoryTarget)
+    {
+        m_fallback.Extract(info, options, callback);
+        return;
+    }
+
+    // libarchive is never given a password; 7-Zip asks for one
+    if (info.isEncrypted)
+    {
+        LOG_INFO(L"Archive is encrypted, extracting with 7-Zip: " + info.archivePath);
+        m_fallback.Extract(info, options, callback);
+        return;
+    }
+
+    std::wstring dest = DetermineDestination(info, options);
+
+    // Prompt is settled here, where the callback can ask; the worker gets the answer
+    OverwritePolicy policy = options.overwritePolicy;
+    if (policy == OverwritePolicy::Prompt)
+    {
+        DestinationSnapshot existing(dest);
+        policy = existing.ResolvePolicy(policy, info, EntrySelector(options.selection), PathValidator(dest), callback);
+    }
+
+    // If libarchive gives up partway, the files it finished are complete (a
+    // failed entry is deleted), so 7-Zip can take over by overwriting or
+    // skipping them. Renaming would duplicate them instead, unless nothing of
+    // the user's was there: then overwriting only meets the worker's own files.
+    bool destinationWasEmpty = policy == OverwritePolicy::AutoRename && DestinationSnapshot(dest).IsEmpty();
+
+    LOG_INFO(L"Extracting in worker process: " + info.archivePath);
+
+    std::wstring message;
+    ErrorCode errorCode = ErrorCode::ExtractionFailed;
+    WorkerPool::JobResult result = WorkerPool::GetInstance().Extract(info.archivePath, dest, policy, options, callback,
+                                                                     m_cancelled, message, errorCode);
+    switch (result)
+    {
+    case WorkerPool::JobResult::Completed:
+    case WorkerPool::JobResult::Failed:
+        break;
+    case WorkerPool::JobResult::Cancelled:
+        LOG_INFO(L"Extraction was cancelled by user");
+        if (callback) callback->OnError(ErrorCode::CancellationRequested, L"Cancelled");
+        break;
+    case WorkerPool::JobResult::NotStarted:
+        // Nothing was written yet; 7-Zip reads formats libarchive can't
+        LOG_WARNING(L"Worker extraction did not start (" + message + L"), falling back to 7-Zip");
+        ExtractWithFallback(info, options, dest, policy, callback);
+        break;
+    case WorkerPool::JobResult::Unsupported:
+        if (policy == OverwritePolicy::AutoRename && !destinationWasEmpty)
+        {
+            LOG_ERROR(L"Worker extraction stopped (" + message + L"); 7-Zip can't resume it without duplicating files");
+            if (callback) callback->OnError(errorCode, message);
+            break;
+        }
+        LOG_WARNING(L"Worker extraction stopped (" + message + L"), finishing with 7-Zip");
+        ExtractWithFallback(info, options, dest, destinationWasEmpty ? OverwritePolicy::Overwrite : policy, callback);
+        break;
+    }
+}
+
+void WorkerProcessEngine::ExtractWithFallback(const ArchiveInfo& info, const ExtractionOptions& options,
+                                              const std::wstring& destination, OverwritePolicy policy,
+                                              IProgressCallback* callback)
+{
+    if (m_cancelled)
+    {
+        if (callback) callback->OnError(ErrorCode::CancellationRequested, L"Cancelled");
+        return;
+    }
+
+    ExtractionOptions fallbackOptions = options;
+    fallbackOptions.destinationPath = destination;
+    fallbackOptions.overwritePolicy = policy;
+    m_fallback.Extract(info, fallbackOptions, callback);
+}
+
+void WorkerProcessEngine::CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>& sourceFiles, const std::wstring& format, const CompressionProfile& profile, IProgressCallback* callback)
+{
+    m_fallback.CreateArchive(destinationPath, sourceFiles, format, profile, callback);
+}
+
+void WorkerProcessEngine::Cancel()
+{
+    m_cancelled = true;
+    m_fallback.Cancel();
+    // The worker is stopped from the wait loop in WorkerPool::Extract
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,42 @@
+#pragma once
+#include "IExtractionEngine.h"
+#include "SevenZipEngine.h"
+#include <atomic>
+#include <string>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Extraction engine that runs libarchive in pooled worker processes
+/// (WorkerPool). Keeps the crash isolation of a separate process without
+/// paying a process launch per archive; header scans run in a worker too.
+/// Encrypted archives go to 7z.exe, and so do jobs no worker could start and
+/// jobs that hit a format or feature libarchive lacks. Archive creation
+/// always goes to 7-Zip.
+/// </summary>
+class WorkerProcessEngine : public IExtractionEngine
+{
+public:
+    WorkerProcessEngine();
+    ~WorkerProcessEngine();
+
+    bool CanHandle(const std::wstring& archivePath) override;
+    ArchiveInfo GetArchiveInfo(const std::wstring& archivePath) override;
+    void Extract(const ArchiveInfo& info, const ExtractionOptions& options, IProgressCallback* callback) override;
+    void CreateArchive(const std::wstring& destinationPath, const std::vector<std::wstring>& sourceFiles, const std::wstring& format, const CompressionProfile& profile, IProgressCallback* callback) override;
+    void Cancel() override;
+    std::wstring GetEngineName() const override { return L"libarchive (Worker Process)"; }
+
+private:
+    std::atomic<bool> m_cancelled{false};
+    SevenZipEngine m_fallback;
+
+    // Helpers
+    std::wstring DetermineDestination(const ArchiveInfo& info, const ExtractionOptions& options);
+
+    // Hand the job to 7-Zip with the destination and policy already settled
+    void ExtractWithFallback(const ArchiveInfo& info, const ExtractionOptions& options, const std::wstring& destination,
+                             OverwritePolicy policy, IProgressCallback* callback);
+};
+
+} // namespace ZipSpark
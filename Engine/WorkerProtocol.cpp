@@ -0,0 +1,116 @@
+#include "WorkerProtocol.h"
+#include "../Utils/Utf8.h"
+
+namespace ZipSpark {
+
+static void AppendField(std::string& out, std::wstring_view field, std::string& scratch)
+{
+    Utf8::FromWide(field, scratch);
+    for (char c : scratch)
+    {
+        switch (c)
+        {
+        case '\\': out += "\\\\"; break;
+        case '\t': out += "\\t"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        default: out += c; break;
+        }
+    }
+}
+
+void WorkerProtocol::AppendMessage(std::string& out, std::initializer_list<std::wstring_view> fields)
+{
+    AppendMessage(out, fields, {});
+}
+
+void WorkerProtocol::AppendMessage(std::string& out, std::initializer_list<std::wstring_view> fields,
+                                   const std::vector<std::wstring>& moreFields)
+{
+    std::string scratch;
+    bool first = true;
+    for (std::wstring_view field : fields)
+    {
+        if (!first)
+        {
+            out += '\t';
+        }
+        first = false;
+        AppendField(out, field, scratch);
+    }
+    for (const std::wstring& field : moreFields)
+    {
+        if (!first)
+        {
+            out += '\t';
+        }
+        first = false;
+        AppendField(out, field, scratch);
+    }
+    out += '\n';
+}
+
+void WorkerProtocol::Split(std::string_view line, std::vector<std::wstring>& fields)
+{
+    size_t count = 0;
+    std::string field;
+    size_t pos = 0;
+    while (true)
+    {
+        size_t end = line.find('\t', pos);
+        std::string_view raw = line.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+
+        field.clear();
+        for (size_t i = 0; i < raw.size(); i++)
+        {
+            if (raw[i] != '\\' || i + 1 == raw.size())
+            {
+                field += raw[i];
+                continue;
+            }
+            switch (raw[++i])
+            {
+            case 't': field += '\t'; break;
+            case 'n': field += '\n'; break;
+            case 'r': field += '\r'; break;
+            default: field += raw[i]; break;
+            }
+        }
+
+        if (count == fields.size())
+        {
+            fields.emplace_back();
+        }
+        Utf8::ToWide(field, fields[count++]);
+
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        pos = end + 1;
+    }
+    fields.resize(count);
+}
+
+bool WorkerProtocol::NextLine(std::string& buffer, size_t& consumed, std::string_view& line)
+{
+    size_t end = buffer.find('\n', consumed);
+    if (end == std::string::npos)
+    {
+        // Drop what was taken so far; keep the partial line for the next read
+        buffer.erase(0, consumed);
+        consumed = 0;
+        return false;
+    }
+
+    size_t length = end - consumed;
+    if (length > 0 && buffer[end - 1] == '\r')
+    {
+        length--;
+    }
+    line = std::string_view(buffer).substr(consumed, length);
+    consumed = end + 1;
+    return true;
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,44 @@
+#pragma once
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Line protocol between the app and its extraction workers (WorkerPool on
+/// the app side, ExtractionWorker in the worker). One message per line;
+/// fields are UTF-8 separated by tabs, with backslash, tab, CR and LF escaped
+/// inside a field. Portable (no Win32 dependency).
+///
+/// Requests:  EXTRACT archive destination policy timestamps permissions threads bufferSize
+///                    writeBufferSize unbufferedThreshold pipelineLimit writeBackend mapLimit
+///                    cacheToMemory memoryBudget [selection...]
+///            SCAN archive
+/// Responses: START files | PROGRESS percent bytes total | FILE index total name
+///            COMPLETE destination | ERROR code message
+///            SCANNED complete files directories bytes encrypted singleRoot
+/// Every EXTRACT ends with exactly one COMPLETE or ERROR, every SCAN with one SCANNED.
+/// </summary>
+class WorkerProtocol
+{
+public:
+    // Command-line switch that starts the executable as a worker
+    static constexpr const wchar_t* WORKER_SWITCH = L"--extraction-worker";
+
+    // Append one message (with its newline) to out
+    static void AppendMessage(std::string& out, std::initializer_list<std::wstring_view> fields);
+
+    // Append one message whose trailing fields come from a list
+    static void AppendMessage(std::string& out, std::initializer_list<std::wstring_view> fields,
+                              const std::vector<std::wstring>& moreFields);
+
+    // Decode a line (without its newline) into fields, reusing their storage
+    static void Split(std::string_view line, std::vector<std::wstring>& fields);
+
+    // Take the next complete line off the front of buffer; false if none yet
+    static bool NextLine(std::string& buffer, size_t& consumed, std::string_view& line);
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,252 @@
+#include "pch.h"
+#include "WritePipeline.h"
+#include "DirectoryCache.h"
+#include "OutputFile.h"
+#include "../Utils/Logger.h"
+#include <cstring>
+#include <unordered_map>
+
+namespace ZipSpark {
+
+BlockRing::BlockRing(size_t slotCount, size_t slotSize)
+    : m_slotSize(slotSize)
+    , m_storage(new char[slotCount * slotSize])
+{
+    m_free.reserve(slotCount);
+    for (size_t i = 0; i < slotCount; i++)
+    {
+        m_free.push_back(m_storage.get() + i * slotSize);
+    }
+}
+
+char* BlockRing::Acquire()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_available.wait(lock, [this]() { return !m_free.empty(); });
+
+    char* slot = m_free.back();
+    m_free.pop_back();
+    return slot;
+}
+
+void BlockRing::Release(char* slot)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(slot);
+    }
+    m_available.notify_one();
+}
+
+WritePipeline::WritePipeline(DirectoryCache& directories, const ExtractionOptions& options,
+                             uint32_t writerCount, size_t slotCount, size_t slotSize)
+    : m_directories(directories)
+    , m_options(options)
+    , m_ring(slotCount, slotSize)
+{
+    writerCount = std::max<uint32_t>(writerCount, 1);
+    for (uint32_t i = 0; i < writerCount; i++)
+    {
+        m_lanes.push_back(std::make_unique<Lane>());
+    }
+
+    for (auto& lane : m_lanes)
+    {
+        Lane* lanePtr = lane.get();
+        lane->thread = std::thread([this, lanePtr]() { RunLane(*lanePtr); });
+    }
+}
+
+WritePipeline::~WritePipeline()
+{
+    Finish();
+}
+
+uint32_t WritePipeline::BeginFile(const std::wstring& relativePath, bool sparse, int64_t length)
+{
+    uint32_t fileId = m_nextFileId++;
+
+    Command command{ CommandType::Open, fileId };
+    command.path = relativePath;
+    command.sparse = sparse;
+    command.offset = length;
+    Enqueue(fileId, std::move(command));
+    return fileId;
+}
+
+void WritePipeline::Write(uint32_t fileId, const void* data, size_t size, int64_t offset)
+{
+    // libarchive reuses its block buffer on the next read call, so blocks are
+    // copied into ring slots; large blocks span several slots
+    const char* source = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        size_t chunk = std::min(size, m_ring.GetSlotSize());
+        char* slot = m_ring.Acquire();
+        memcpy(slot, source, chunk);
+
+        Command command{ CommandType::Write, fileId };
+        command.slot = slot;
+        command.size = chunk;
+        command.offset = offset;
+        Enqueue(fileId, std::move(command));
+
+        source += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+}
+
+void WritePipeline::EndFile(uint32_t fileId, int64_t length)
+{
+    Command command{ CommandType::Close, fileId };
+    command.offset = length;
+    Enqueue(fileId, std::move(command));
+}
+
+void WritePipeline::DiscardFile(uint32_t fileId)
+{
+    Command command{ CommandType::Close, fileId };
+    command.offset = -1;
+    command.discard = true;
+    Enqueue(fileId, std::move(command));
+}
+
+void WritePipeline::Enqueue(uint32_t fileId, Command command)
+{
+    Lane& lane = *m_lanes[fileId % m_lanes.size()];
+    {
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        lane.commands.push_back(std::move(command));
+    }
+    lane.ready.notify_one();
+}
+
+bool WritePipeline::Finish()
+{
+    if (m_finished)
+    {
+        return !m_failed;
+    }
+    m_finished = true;
+
+    for (auto& lane : m_lanes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(lane->mutex);
+            lane->stopping = true;
+        }
+        lane->ready.notify_one();
+    }
+
+    for (auto& lane : m_lanes)
+    {
+        if (lane->thread.joinable())
+        {
+            lane->thread.join();
+        }
+    }
+
+    return !m_failed;
+}
+
+void WritePipeline::RunLane(Lane& lane)
+{
+    // Files are pinned to a lane, so only this thread touches them
+    std::unordered_map<uint32_t, OutputFile> files;
+
+    while (true)
+    {
+        Command command;
+        {
+            std::unique_lock<std::mutex> lock(lane.mutex);
+            lane.ready.wait(lock, [&lane]() { return !lane.commands.empty() || lane.stopping; });
+            if (lane.commands.empty())
+            {
+                break; // Stopping and fully drained
+            }
+            command = std::move(lane.commands.front());
+            lane.commands.pop_front();
+        }
+
+        try
+        {
+            switch (command.type)
+            {
+            case CommandType::Open:
+            {
+                OutputFile outFile;
+                if (!m_directories.OpenOutputFile(command.path, command.sparse, command.offset, m_options, outFile))
+                {
+                    if (GetLastError() == ERROR_DISK_FULL)
+                    {
+                        Fail(L"Not enough disk space for " + m_directories.GetRoot() + L"\\" + command.path);
+                        break;
+                    }
+                    LOG_ERROR(L"Failed to create file: " + m_directories.GetRoot() + L"\\" + command.path);
+                    break; // Later writes for this file are dropped
+                }
+                files.emplace(command.fileId, std::move(outFile));
+                break;
+            }
+            case CommandType::Write:
+            {
+                auto it = files.find(command.fileId);
+                if (it != files.end())
+                {
+                    if (!it->second.WriteAt(command.slot, command.size, command.offset))
+                    {
+                        Fail(L"Failed to write extracted data (disk full?)");
+                    }
+                }
+                break;
+            }
+            case CommandType::Close:
+            {
+                auto it = files.find(command.fileId);
+                if (it != files.end())
+                {
+                    if (command.discard)
+                    {
+                        it->second.Discard();
+                    }
+                    else if (command.offset >= 0 && !it->second.SetLength(static_cast<uint64_t>(command.offset)))
+                    {
+                        Fail(L"Failed to set extracted file size (disk full?)");
+                    }
+                    files.erase(it);
+                }
+                break;
+            }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::string what = e.what();
+            Fail(std::wstring(what.begin(), what.end()));
+        }
+
+        if (command.slot)
+        {
+            m_ring.Release(command.slot);
+        }
+    }
+}
+
+void WritePipeline::Fail(const std::wstring& message)
+{
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    if (!m_failed.exchange(true))
+    {
+        m_error = message;
+        LOG_ERROR(L"Write pipeline error: " + message);
+    }
+}
+
+std::wstring WritePipeline::GetError()
+{
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    return m_error;
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,114 @@
+#pragma once
+#include "IOutputBackend.h"
+#include "../Core/ExtractionOptions.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ZipSpark {
+
+class DirectoryCache;
+
+/// <summary>
+/// Fixed set of equally sized block buffers that circulate between the decoder
+/// and the writers. Acquire blocks while every slot is in flight, which is the
+/// backpressure that keeps pipeline memory at slotCount * slotSize.
+/// </summary>
+class BlockRing
+{
+public:
+    BlockRing(size_t slotCount, size_t slotSize);
+
+    size_t GetSlotSize() const { return m_slotSize; }
+
+    // Wait for a free slot
+    char* Acquire();
+
+    // Hand a slot back once its contents are written
+    void Release(char* slot);
+
+private:
+    size_t m_slotSize;
+    std::unique_ptr<char[]> m_storage;
+    std::vector<char*> m_free;
+    std::mutex m_mutex;
+    std::condition_variable m_available;
+};
+
+/// <summary>
+/// Decoupled decode/write stages for extraction (thread pool backend).
+/// The decoder thread copies decoded blocks into the ring and queues them;
+/// a pool of writer threads drains the queues to disk. Each file is pinned to
+/// one writer lane so its open, writes and close stay in order.
+/// </summary>
+class WritePipeline : public IOutputBackend
+{
+public:
+    WritePipeline(DirectoryCache& directories, const ExtractionOptions& options,
+                  uint32_t writerCount, size_t slotCount, size_t slotSize);
+    ~WritePipeline();
+
+    uint32_t BeginFile(const std::wstring& relativePath, bool sparse = false, int64_t length = -1) override;
+    void Write(uint32_t fileId, const void* data, size_t size, int64_t offset) override;
+    void EndFile(uint32_t fileId, int64_t length = -1) override;
+    void DiscardFile(uint32_t fileId) override;
+
+    // Drain all queued work and stop the writers. Returns false if any write failed.
+    bool Finish() override;
+
+    bool HasFailed() const override { return m_failed; }
+    std::wstring GetError() override;
+    std::wstring GetBackendName() const override { return L"writer threads"; }
+
+private:
+    enum class CommandType
+    {
+        Open,
+        Write,
+        Close
+    };
+
+    struct Command
+    {
+        CommandType type;
+        uint32_t fileId;
+        std::wstring path;           // Open only
+        bool sparse = false;         // Open only
+        bool discard = false;        // Close only: delete instead of keeping
+        char* slot = nullptr;        // Write only
+        size_t size = 0;
+        int64_t offset = 0;          // Write: file offset; Open/Close: final length or -1
+    };
+
+    struct Lane
+    {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<Command> commands;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    void Enqueue(uint32_t fileId, Command command);
+    void RunLane(Lane& lane);
+    void Fail(const std::wstring& message);
+
+    DirectoryCache& m_directories;
+    const ExtractionOptions& m_options;
+    BlockRing m_ring;
+    std::vector<std::unique_ptr<Lane>> m_lanes;
+    uint32_t m_nextFileId = 0;
+    bool m_finished = false;
+
+    std::atomic<bool> m_failed{ false };
+    std::mutex m_errorMutex;
+    std::wstring m_error;
+};
+
+} // namespace ZipSpark
@@ -13,6 +13,7 @@
 #include "Utils/Logger.h"
 #include "Utils/NotificationManager.h"
 #include "Utils/RecentFiles.h"
+#include "Utils/Settings.h"
 #include <winrt/Microsoft.UI.Composition.SystemBackdrops.h>
 #include <winrt/Microsoft.UI.Xaml.Media.h>
 #include <winrt/Microsoft.UI.Xaml.Controls.h>
@@ -448,6 +449,8 @@ namespace winrt::ZipSpark_New::implementation
             ZipSpark::ExtractionOptions options;
             options.createSubfolder = !info.hasSingleRoot;
             options.overwritePolicy = ZipSpark::OverwritePolicy::AutoRename;
+            options.stallTimeoutMs = ZipSpark::Settings::GetInstance().stallTimeoutSeconds * 1000;
+            options.deadlineMs = ZipSpark::Settings::GetInstance().extractionDeadlineSeconds * 1000;
             
             LOG_INFO(L"Starting extraction with thread-safe callbacks");
             
@@ -955,8 +958,14 @@ namespace winrt::ZipSpark_New::implementation
             // Store engine to keep it alive during operation
             strong_this->m_currentEngine.reset(engine.release());
             
+            // Level from the dialog's slider, threads and dictionary sized for this machine
+            ZipSpark::CompressionProfile profile = ZipSpark::CompressionProfile::ForThisMachine(
+                static_cast<ZipSpark::CompressionLevel>(compressionLevel), format);
+            LOG_INFO(L"Compression: level " + std::to_wstring(profile.level) + L", " + std::to_wstring(profile.threadCount) +
+                     L" threads, dictionary " + std::to_wstring(profile.dictionarySize / (1024 * 1024)) + L" MB");
+            
             // Create the archive (blocking call on background thread)
-            strong_this->m_currentEngine->CreateArchive(destPath, files, format, &callback);
+            strong_this->m_currentEngine->CreateArchive(destPath, files, format, profile, &callback);
             
             // Clean up engine
             strong_this->m_currentEngine.reset();
@@ -45,19 +45,12 @@ namespace winrt::ZipSpark_New::implementation
             winrt::Microsoft::UI::Dispatching::DispatcherQueue m_dispatcher;
             winrt::weak_ref<implementation::MainWindow> m_weakTarget;
             
-            // Throttling
-            std::chrono::steady_clock::time_point m_lastUIUpdate;
-            std::chrono::steady_clock::time_point m_lastFileUIUpdate;
-            
         public:
             ThreadSafeCallback(
                 winrt::Microsoft::UI::Dispatching::DispatcherQueue dispatcher,
                 winrt::weak_ref<implementation::MainWindow> weakTarget)
                 : m_dispatcher(dispatcher), m_weakTarget(weakTarget)
             {
-                auto now = std::chrono::steady_clock::now();
-                m_lastUIUpdate = now;
-                m_lastFileUIUpdate = now;
             }
             
             void OnStart(int totalFiles) override
@@ -77,15 +70,7 @@ namespace winrt::ZipSpark_New::implementation
             
             void OnProgress(int percentComplete, uint64_t bytesProcessed, uint64_t totalBytes) override
             {
-                // Throttling: 10fps (100ms)
-                auto now = std::chrono::steady_clock::now();
-                if (percentComplete < 100 && 
-                    std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastUIUpdate).count() < 100)
-                {
-                    return;
-                }
-                m_lastUIUpdate = now;
-
+                // Engines already coalesce progress (ProgressAggregator), so forward every update
                 bool enqueued = m_dispatcher.TryEnqueue([weakTarget = m_weakTarget, percentComplete, bytesProcessed, totalBytes]() {
                     if (auto target = weakTarget.get())
                     {
@@ -100,15 +85,7 @@ namespace winrt::ZipSpark_New::implementation
             
             void OnFileProgress(const std::wstring& currentFile, int fileIndex, int totalFiles) override
             {
-                // Throttling: 10fps (100ms)
-                auto now = std::chrono::steady_clock::now();
-                if (fileIndex < totalFiles && 
-                    std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastFileUIUpdate).count() < 100)
-                {
-                    return;
-                }
-                m_lastFileUIUpdate = now;
-
+                // Coalesced by the engine like OnProgress
                 bool enqueued = m_dispatcher.TryEnqueue([weakTarget = m_weakTarget, currentFile, fileIndex, totalFiles]() {
                     if (auto target = weakTarget.get())
                     {
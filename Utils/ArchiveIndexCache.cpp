@@ -0,0 +1,407 @@
+#include "pch.h"
+#include "ArchiveIndexCache.h"
+#include "Logger.h"
+#include "Settings.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace ZipSpark {
+
+constexpr uint32_t INDEX_FILE_MAGIC = 0x5853495A; // "ZISX"
+constexpr uint32_t INDEX_FILE_VERSION = 2;
+
+// Bytes hashed at each end of the archive for the content fingerprint
+constexpr size_t FINGERPRINT_BYTES = 4096;
+
+/// <summary>
+/// Header of an index cache file. Layout:
+/// header | archive path (wchar_t, padded to 8) | ArchiveIndexEntry[entryCount] | name pool
+/// </summary>
+struct IndexFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t archiveSize;
+    int64_t archiveModifiedTime;
+    uint64_t fingerprint;
+    uint64_t entryCount;
+    uint64_t namesSize;
+    uint64_t totalSize;
+    uint32_t fileCount;
+    uint32_t directoryCount;
+    uint32_t pathLength;  // wchar_t count
+    uint8_t isEncrypted;
+    uint8_t hasSingleRoot;
+    uint16_t entrySize;   // sizeof(ArchiveIndexEntry) when written
+};
+
+static size_t PaddedPathBytes(uint32_t pathLength)
+{
+    return (pathLength * sizeof(wchar_t) + 7) & ~static_cast<size_t>(7);
+}
+
+static uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/// <summary>
+/// Read-only mapping of a cache file; owns the handles for the index viewing it
+/// </summary>
+struct MappedIndexFile
+{
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+    const uint8_t* view = nullptr;
+    uint64_t size = 0;
+
+    ~MappedIndexFile()
+    {
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    }
+
+    bool Open(const std::wstring& path)
+    {
+        // Share delete: eviction may remove a file that is still mapped here
+        file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(IndexFileHeader)))
+        {
+            return false;
+        }
+        size = static_cast<uint64_t>(fileSize.QuadPart);
+
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            return false;
+        }
+        view = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        return view != nullptr;
+    }
+};
+
+bool ArchiveIndexCache::GetIdentity(const std::wstring& archivePath, ArchiveIdentity& identity)
+{
+    std::error_code ec;
+    fs::path path = fs::absolute(fs::path(archivePath), ec).lexically_normal();
+    if (ec)
+    {
+        return false;
+    }
+
+    identity.path = path.wstring();
+    std::transform(identity.path.begin(), identity.path.end(), identity.path.begin(), ::towlower);
+
+    identity.size = fs::file_size(path, ec);
+    if (ec)
+    {
+        return false;
+    }
+    identity.modifiedTime = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    if (ec)
+    {
+        return false;
+    }
+
+    // Size and mtime survive some rewrites (copies with preserved times,
+    // coarse timestamps); the first and last pages cover headers and directories
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    char buffer[FINGERPRINT_BYTES];
+    file.read(buffer, sizeof(buffer));
+    identity.fingerprint = Fnv1a(buffer, static_cast<size_t>(file.gcount()));
+
+    if (identity.size > FINGERPRINT_BYTES)
+    {
+        file.clear();
+        file.seekg(-static_cast<std::streamoff>(FINGERPRINT_BYTES), std::ios::end);
+        file.read(buffer, sizeof(buffer));
+        identity.fingerprint = Fnv1a(buffer, static_cast<size_t>(file.gcount()), identity.fingerprint);
+    }
+    return true;
+}
+
+std::wstring ArchiveIndexCache::GetCacheDirectory()
+{
+    if (m_cacheDirectory.empty())
+    {
+        // Temp directory like the logger: disposable data, always writable
+        wchar_t tempPath[MAX_PATH];
+        DWORD result = GetTempPathW(MAX_PATH, tempPath);
+        if (result == 0 || result > MAX_PATH)
+        {
+            return L"";
+        }
+
+        std::wstring directory = std::wstring(tempPath) + L"ZipSpark\\IndexCache";
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+        if (ec)
+        {
+            return L"";
+        }
+        m_cacheDirectory = directory;
+    }
+    return m_cacheDirectory;
+}
+
+std::wstring ArchiveIndexCache::GetCacheFilePath(const ArchiveIdentity& identity)
+{
+    std::wstring directory = GetCacheDirectory();
+    if (directory.empty())
+    {
+        return L"";
+    }
+
+    uint64_t key = Fnv1a(identity.path.data(), identity.path.size() * sizeof(wchar_t));
+    wchar_t name[32];
+    swprintf_s(name, L"%016llx.idx", static_cast<unsigned long long>(key));
+    return directory + L"\\" + name;
+}
+
+std::shared_ptr<const ArchiveIndex> ArchiveIndexCache::Lookup(const std::wstring& archivePath)
+{
+    try
+    {
+        ArchiveIdentity identity;
+        if (!GetIdentity(archivePath, identity))
+        {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::wstring cachePath = GetCacheFilePath(identity);
+        if (cachePath.empty())
+        {
+            return nullptr;
+        }
+
+        auto mapped = std::make_shared<MappedIndexFile>();
+        if (!mapped->Open(cachePath))
+        {
+            return nullptr;
+        }
+
+        IndexFileHeader header;
+        memcpy(&header, mapped->view, sizeof(header));
+        if (header.magic != INDEX_FILE_MAGIC || header.version != INDEX_FILE_VERSION ||
+            header.entrySize != sizeof(ArchiveIndexEntry) ||
+            header.archiveSize != identity.size || header.archiveModifiedTime != identity.modifiedTime ||
+            header.fingerprint != identity.fingerprint || header.pathLength != identity.path.size())
+        {
+            return nullptr;
+        }
+
+        // Bounds: a truncated or foreign file must not be read past its end
+        uint64_t pathBytes = PaddedPathBytes(header.pathLength);
+        uint64_t entriesOffset = sizeof(IndexFileHeader) + pathBytes;
+        if (entriesOffset > mapped->size ||
+            header.entryCount > (mapped->size - entriesOffset) / sizeof(ArchiveIndexEntry))
+        {
+            return nullptr;
+        }
+        uint64_t namesOffset = entriesOffset + header.entryCount * sizeof(ArchiveIndexEntry);
+        if (header.namesSize > mapped->size - namesOffset)
+        {
+            return nullptr;
+        }
+
+        // Hash collisions on the file name
+        if (memcmp(mapped->view + sizeof(IndexFileHeader), identity.path.data(), identity.path.size() * sizeof(wchar_t)) != 0)
+        {
+            return nullptr;
+        }
+
+        const auto* entries = reinterpret_cast<const ArchiveIndexEntry*>(mapped->view + entriesOffset);
+        const char* names = reinterpret_cast<const char*>(mapped->view + namesOffset);
+        for (uint64_t i = 0; i < header.entryCount; i++)
+        {
+            if (static_cast<uint64_t>(entries[i].nameOffset) + entries[i].nameLength > header.namesSize)
+            {
+                return nullptr;
+            }
+        }
+
+        ArchiveIndex::Summary summary;
+        summary.totalSize = header.totalSize;
+        summary.fileCount = header.fileCount;
+        summary.directoryCount = header.directoryCount;
+        summary.isEncrypted = header.isEncrypted != 0;
+        summary.hasSingleRoot = header.hasSingleRoot != 0;
+
+        // Mark as recently used for eviction
+        std::error_code ec;
+        fs::last_write_time(cachePath, fs::file_time_type::clock::now(), ec);
+
+        return std::make_shared<const ArchiveIndex>(mapped, entries, static_cast<size_t>(header.entryCount),
+                                                    names, static_cast<size_t>(header.namesSize), summary);
+    }
+    catch (const std::exception& e)
+    {
+        std::string what = e.what();
+        std::wstring wwhat(what.begin(), what.end());
+        LOG_ERROR(L"Index cache lookup failed: " + wwhat);
+        return nullptr;
+    }
+}
+
+void ArchiveIndexCache::Store(const std::wstring& archivePath, const ArchiveIndex& index, bool always)
+{
+    if (index.GetEntryCount() < MIN_CACHED_ENTRIES && !always)
+    {
+        return;
+    }
+
+    try
+    {
+        ArchiveIdentity identity;
+        if (!GetIdentity(archivePath, identity))
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::wstring cachePath = GetCacheFilePath(identity);
+        if (cachePath.empty())
+        {
+            return;
+        }
+
+        const ArchiveIndex::Summary& summary = index.GetSummary();
+        IndexFileHeader header = {};
+        header.magic = INDEX_FILE_MAGIC;
+        header.version = INDEX_FILE_VERSION;
+        header.archiveSize = identity.size;
+        header.archiveModifiedTime = identity.modifiedTime;
+        header.fingerprint = identity.fingerprint;
+        header.entryCount = index.GetEntryCount();
+        header.namesSize = index.GetNamePoolSize();
+        header.totalSize = summary.totalSize;
+        header.fileCount = summary.fileCount;
+        header.directoryCount = summary.directoryCount;
+        header.pathLength = static_cast<uint32_t>(identity.path.size());
+        header.isEncrypted = summary.isEncrypted ? 1 : 0;
+        header.hasSingleRoot = summary.hasSingleRoot ? 1 : 0;
+        header.entrySize = sizeof(ArchiveIndexEntry);
+
+        // Write next to the target and rename, so readers never see a partial file
+        std::wstring tempPath = cachePath + L".tmp";
+        {
+            std::ofstream file(fs::path(tempPath), std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                return;
+            }
+
+            std::vector<char> pathBytes(PaddedPathBytes(header.pathLength), 0);
+            memcpy(pathBytes.data(), identity.path.data(), identity.path.size() * sizeof(wchar_t));
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(pathBytes.data(), pathBytes.size());
+            file.write(reinterpret_cast<const char*>(index.GetEntries()), index.GetEntryCount() * sizeof(ArchiveIndexEntry));
+            file.write(index.GetNamePool(), index.GetNamePoolSize());
+            if (!file)
+            {
+                file.close();
+                fs::remove(tempPath);
+                return;
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(tempPath, cachePath, ec);
+        if (ec)
+        {
+            fs::remove(tempPath, ec);
+            return;
+        }
+
+        LOG_INFO(L"Cached index of " + std::to_wstring(index.GetEntryCount()) + L" entries: " + archivePath);
+        Evict(Settings::GetInstance().indexCacheBudget);
+    }
+    catch (const std::exception& e)
+    {
+        std::string what = e.what();
+        std::wstring wwhat(what.begin(), what.end());
+        LOG_ERROR(L"Failed to store archive index: " + wwhat);
+    }
+}
+
+void ArchiveIndexCache::Evict(uint64_t budget)
+{
+    struct CacheFile
+    {
+        fs::path path;
+        fs::file_time_type lastUsed;
+        uint64_t size;
+    };
+
+    std::vector<CacheFile> files;
+    uint64_t totalSize = 0;
+
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(GetCacheDirectory(), ec))
+    {
+        if (item.path().extension() != L".idx")
+        {
+            continue;
+        }
+        CacheFile file{ item.path(), item.last_write_time(ec), item.file_size(ec) };
+        totalSize += file.size;
+        files.push_back(std::move(file));
+    }
+
+    if (totalSize <= budget)
+    {
+        return;
+    }
+
+    // Oldest use first
+    std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) {
+        return a.lastUsed < b.lastUsed;
+    });
+
+    for (const auto& file : files)
+    {
+        if (totalSize <= budget)
+        {
+            break;
+        }
+        if (fs::remove(file.path, ec))
+        {
+            totalSize -= file.size;
+        }
+    }
+}
+
+void ArchiveIndexCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Evict(0);
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,72 @@
+#pragma once
+#include "pch.h"
+#include "../Core/ArchiveIndex.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ZipSpark {
+
+/// <summary>
+/// On-disk cache of archive entry tables.
+/// Indexes are keyed by archive identity (path, size, modification time and a
+/// fingerprint of the first and last 4 KB), stored one file per archive in a
+/// fixed binary layout and used in place through a read-only mapping.
+/// Least recently used files are evicted once the cache exceeds its budget.
+/// </summary>
+class ArchiveIndexCache
+{
+public:
+    static ArchiveIndexCache& GetInstance()
+    {
+        static ArchiveIndexCache instance;
+        return instance;
+    }
+
+    /// <summary>
+    /// Cached index for this exact archive, or nullptr if there is none or the
+    /// archive changed since it was stored
+    /// </summary>
+    std::shared_ptr<const ArchiveIndex> Lookup(const std::wstring& archivePath);
+
+    /// <summary>
+    /// Archives with fewer entries are rescanned faster than a cache file is written
+    /// </summary>
+    static constexpr size_t MIN_CACHED_ENTRIES = 1024;
+
+    /// <summary>
+    /// Store a complete index for an archive and evict old entries over budget.
+    /// Indexes under MIN_CACHED_ENTRIES are skipped unless always is set (the
+    /// index is handed to another process through the cache).
+    /// </summary>
+    void Store(const std::wstring& archivePath, const ArchiveIndex& index, bool always = false);
+
+    /// <summary>
+    /// Remove every cached index
+    /// </summary>
+    void Clear();
+
+private:
+    ArchiveIndexCache() = default;
+    ArchiveIndexCache(const ArchiveIndexCache&) = delete;
+    ArchiveIndexCache& operator=(const ArchiveIndexCache&) = delete;
+
+    struct ArchiveIdentity
+    {
+        std::wstring path;  // Lower-cased full path
+        uint64_t size = 0;
+        int64_t modifiedTime = 0;
+        uint64_t fingerprint = 0;
+    };
+
+    static bool GetIdentity(const std::wstring& archivePath, ArchiveIdentity& identity);
+    std::wstring GetCacheDirectory();
+    std::wstring GetCacheFilePath(const ArchiveIdentity& identity);
+    void Evict(uint64_t budget);
+
+    std::mutex m_mutex;
+    std::wstring m_cacheDirectory;
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,249 @@
+#include "EventLog.h"
+#include "Utf8.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ZipSpark {
+
+using EventLogFormat::EventRecord;
+
+// Events and strings of the calling thread not yet in the file (4 KB)
+struct ThreadEventBuffer
+{
+    static constexpr size_t CAPACITY = 128;
+
+    ThreadEventBuffer()
+        : thread(s_nextThread.fetch_add(1, std::memory_order_relaxed))
+    {
+    }
+
+    ~ThreadEventBuffer()
+    {
+        Flush();
+    }
+
+    void Flush()
+    {
+        if (count > 0)
+        {
+            EventLog::GetInstance().WriteRecords(records, count, generation);
+            count = 0;
+        }
+    }
+
+    // Room for consecutive records of the current file, flushing first if the
+    // buffer is too full; nullptr if they would not fit even in an empty buffer
+    EventRecord* Reserve(size_t needed)
+    {
+        // Anything left over from a previous file is dropped
+        uint64_t current = EventLog::GetInstance().m_generation.load(std::memory_order_acquire);
+        if (generation != current)
+        {
+            count = 0;
+            generation = current;
+        }
+
+        if (needed > CAPACITY)
+        {
+            return nullptr;
+        }
+        if (count + needed > CAPACITY)
+        {
+            Flush();
+        }
+
+        EventRecord* reserved = records + count;
+        count += needed;
+        return reserved;
+    }
+
+    EventRecord records[CAPACITY];
+    size_t count = 0;
+    uint64_t generation = 0; // File the buffered records belong to
+    uint16_t thread;
+
+    inline static std::atomic<uint16_t> s_nextThread{ 1 };
+};
+
+static thread_local ThreadEventBuffer t_events;
+
+EventLog& EventLog::GetInstance()
+{
+    static EventLog instance;
+    return instance;
+}
+
+EventLog::~EventLog()
+{
+    Close();
+}
+
+bool EventLog::Open(const std::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    s_enabled = false;
+    m_generation++;
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+
+    m_file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        return false;
+    }
+
+    EventLogFormat::FileHeader header;
+    header.recordSize = sizeof(EventRecord);
+    header.startTime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    m_start = std::chrono::steady_clock::now().time_since_epoch().count();
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    s_enabled = true;
+
+    RemoveOldFiles(path.parent_path());
+    return true;
+}
+
+void EventLog::RemoveOldFiles(const std::filesystem::path& directory)
+{
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (it->path().extension() == ".zsev")
+        {
+            std::error_code timeError;
+            files.emplace_back(it->last_write_time(timeError), it->path());
+        }
+    }
+
+    if (files.size() <= MAX_FILES)
+    {
+        return;
+    }
+
+    // Newest first; the file just opened is among them
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = MAX_FILES; i < files.size(); i++)
+    {
+        std::filesystem::remove(files[i].second, ec);
+    }
+}
+
+void EventLog::Close()
+{
+    FlushThread();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    s_enabled = false;
+    m_generation++;
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+}
+
+uint64_t EventLog::Now() const
+{
+    auto elapsed = std::chrono::steady_clock::duration(
+        std::chrono::steady_clock::now().time_since_epoch().count() - m_start.load(std::memory_order_relaxed));
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+uint32_t EventLog::AddString(std::string_view utf8)
+{
+    if (!IsEnabled())
+    {
+        return 0;
+    }
+
+    ThreadEventBuffer& buffer = t_events;
+    uint32_t id = m_nextStringId.fetch_add(1, std::memory_order_relaxed);
+
+    EventRecord record;
+    record.timestamp = Now();
+    record.arg0 = id;
+    record.arg1 = utf8.size();
+    record.eventId = static_cast<uint16_t>(EventId::String);
+    record.thread = buffer.thread;
+
+    // Bytes padded to whole records so the stream stays record-aligned
+    size_t byteRecords = (utf8.size() + sizeof(EventRecord) - 1) / sizeof(EventRecord);
+
+    EventRecord* reserved = buffer.Reserve(1 + byteRecords);
+    if (reserved == nullptr)
+    {
+        // Longer than the whole buffer: written on its own, after what the thread buffered
+        buffer.Flush();
+        std::vector<EventRecord> records(1 + byteRecords);
+        records[0] = record;
+        std::memcpy(records.data() + 1, utf8.data(), utf8.size());
+        WriteRecords(records.data(), records.size(), buffer.generation);
+        return id;
+    }
+
+    reserved[0] = record;
+    char* bytes = reinterpret_cast<char*>(reserved + 1);
+    std::memcpy(bytes, utf8.data(), utf8.size());
+    std::memset(bytes + utf8.size(), 0, byteRecords * sizeof(EventRecord) - utf8.size());
+    return id;
+}
+
+uint32_t EventLog::AddString(std::wstring_view text)
+{
+    if (!IsEnabled())
+    {
+        return 0;
+    }
+
+    thread_local std::string utf8;
+    Utf8::FromWide(text, utf8);
+    return AddString(std::string_view(utf8));
+}
+
+void EventLog::Append(EventId event, uint32_t jobId, uint64_t arg0, uint64_t arg1)
+{
+    ThreadEventBuffer& buffer = t_events;
+
+    EventRecord& record = *buffer.Reserve(1);
+    record.timestamp = Now();
+    record.arg0 = arg0;
+    record.arg1 = arg1;
+    record.jobId = jobId;
+    record.eventId = static_cast<uint16_t>(event);
+    record.thread = buffer.thread;
+}
+
+void EventLog::WriteRecords(const EventRecord* records, size_t count, uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file.is_open() && generation == m_generation.load(std::memory_order_relaxed))
+    {
+        m_file.write(reinterpret_cast<const char*>(records), static_cast<std::streamsize>(count * sizeof(EventRecord)));
+    }
+}
+
+void EventLog::FlushThread()
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    t_events.Flush();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file.is_open())
+    {
+        m_file.flush();
+    }
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,92 @@
+#pragma once
+#include "EventLogFormat.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Binary structured event stream for extraction jobs (format in
+/// EventLogFormat.h, decoded offline by ZipSpark.EventDump).
+/// Record() and AddString() only copy into a buffer owned by the calling
+/// thread; full buffers are appended to the file under a lock, one batch at a
+/// time. That keeps per-entry and per-block events cheap enough to leave on.
+/// A disabled log costs one relaxed load. Only the newest MAX_FILES event
+/// files are kept in the log directory. Portable (no Win32 dependency).
+/// </summary>
+class EventLog
+{
+public:
+    using EventId = EventLogFormat::EventId;
+
+    // Event files kept in the directory Open() writes to; older ones are deleted.
+    // Every process writes its own, extraction workers included.
+    static constexpr size_t MAX_FILES = 50;
+
+    static EventLog& GetInstance();
+
+    // Start a new event file (closing any previous one) and delete the oldest
+    // files beside it; false if it can't be created
+    bool Open(const std::filesystem::path& path);
+
+    // Write out the calling thread's events and close the file. Events other
+    // threads have not flushed yet are dropped.
+    void Close();
+
+    static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Id tying together the events of one extraction
+    uint32_t NewJobId() { return m_nextJobId.fetch_add(1, std::memory_order_relaxed); }
+
+    // Write a string to the table and return its id for use as an event argument.
+    // Strings are not deduplicated: keep the id where the same string is used again.
+    uint32_t AddString(std::string_view utf8);
+    uint32_t AddString(std::wstring_view text);
+
+    // Append an event (no-op when disabled)
+    static void Record(EventId event, uint32_t jobId, uint64_t arg0 = 0, uint64_t arg1 = 0)
+    {
+        if (IsEnabled())
+        {
+            GetInstance().Append(event, jobId, arg0, arg1);
+        }
+    }
+
+    // Write out the calling thread's buffered events; call when a thread is
+    // done with a job so its tail is not held back
+    void FlushThread();
+
+private:
+    EventLog() = default;
+    ~EventLog();
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    friend struct ThreadEventBuffer;
+
+    void Append(EventId event, uint32_t jobId, uint64_t arg0, uint64_t arg1);
+
+    // Delete all but the newest MAX_FILES event files in a directory
+    static void RemoveOldFiles(const std::filesystem::path& directory);
+
+    // Write a batch of records; generation guards against writing into a newer file
+    void WriteRecords(const EventLogFormat::EventRecord* records, size_t count, uint64_t generation);
+
+    uint64_t Now() const;
+
+    inline static std::atomic<bool> s_enabled{ false };
+
+    std::mutex m_mutex;
+    std::ofstream m_file;
+    std::atomic<uint64_t> m_generation{ 0 };
+    std::atomic<uint32_t> m_nextJobId{ 1 };
+    std::atomic<uint32_t> m_nextStringId{ 1 };
+    std::atomic<std::chrono::steady_clock::rep> m_start{ 0 }; // steady_clock ticks at Open
+};
+
+} // namespace ZipSpark
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace ZipSpark {
+
+/// <summary>
+/// On-disk layout of the binary event log (".zsev"), shared by EventLog and
+/// the ZipSpark.EventDump decoder. A file is a FileHeader followed by
+/// fixed-size EventRecords. Strings (paths, archive names) are written once as
+/// a String record followed by their UTF-8 bytes padded to whole records;
+/// events refer to them by id. Records are appended in per-thread batches, so
+/// timestamps are only ordered within a thread, and a string added by one
+/// thread may appear after another thread's first event that uses it.
+/// Little-endian, no pointers.
+/// </summary>
+namespace EventLogFormat {
+
+constexpr uint32_t MAGIC = 0x5645535A; // "ZSEV"
+constexpr uint16_t VERSION = 1;
+
+struct FileHeader
+{
+    uint32_t magic = MAGIC;
+    uint16_t version = VERSION;
+    uint16_t recordSize = 0;
+    uint64_t startTime = 0; // Unix time in nanoseconds; record timestamps are relative to it
+};
+static_assert(sizeof(FileHeader) == 16, "FileHeader layout is part of the file format");
+
+enum class EventId : uint16_t
+{
+    String = 0,        // arg0 string id, arg1 byte length; the bytes follow
+    JobStarted = 1,    // arg0 archive (string), arg1 entry count
+    JobFinished = 2,   // arg0 ErrorCode (0 = success), arg1 bytes extracted
+    FileOpened = 3,    // arg0 path (string), arg1 expected size (-1 unknown)
+    FileClosed = 4,    // arg0 path (string), arg1 final size
+    BlockDecoded = 5,  // arg0 offset, arg1 size
+    EntrySkipped = 6,  // arg0 path (string)
+    EntryFailed = 7,   // arg0 path (string), arg1 Win32 error
+    Count
+};
+
+struct EventRecord
+{
+    uint64_t timestamp = 0; // Nanoseconds since FileHeader::startTime
+    uint64_t arg0 = 0;
+    uint64_t arg1 = 0;
+    uint32_t jobId = 0;
+    uint16_t eventId = 0;
+    uint16_t thread = 0;    // Small per-process thread number, not the OS id
+};
+static_assert(sizeof(EventRecord) == 32, "EventRecord layout is part of the file format");
+
+// Names of each event and its arguments, for decoders
+struct EventDescription
+{
+    const char* name;
+    const char* arg0;
+    const char* arg1;
+    bool arg0IsString;
+};
+
+constexpr EventDescription EVENT_DESCRIPTIONS[] = {
+    { "String", "id", "length", false },
+    { "JobStarted", "archive", "entries", true },
+    { "JobFinished", "error", "bytes", false },
+    { "FileOpened", "path", "size", true },
+    { "FileClosed", "path", "size", true },
+    { "BlockDecoded", "offset", "size", false },
+    { "EntrySkipped", "path", nullptr, true },
+    { "EntryFailed", "path", "error", true },
+};
+static_assert(sizeof(EVENT_DESCRIPTIONS) / sizeof(EVENT_DESCRIPTIONS[0]) == static_cast<size_t>(EventId::Count),
+              "Every event needs a description");
+
+} // namespace EventLogFormat
+
+} // namespace ZipSpark
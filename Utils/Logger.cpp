@@ -0,0 +1,306 @@
+#include "pch.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cwchar>
+#include <exception>
+
+namespace ZipSpark
+{
+    // Single-producer/single-consumer ring: the owning thread pushes, the
+    // drain (serialized by m_drainMutex) pops. Capacity is a power of two.
+    class AsyncLogQueue::Ring
+    {
+    public:
+        explicit Ring(size_t capacity)
+        {
+            size_t size = 1;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            m_slots.resize(size);
+            m_mask = size - 1;
+        }
+
+        // False if full
+        bool Push(LogRecord&& record)
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+            {
+                return false;
+            }
+            m_slots[head & m_mask] = std::move(record);
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Past half full: worth waking the flusher early
+        bool IsFilling() const
+        {
+            return m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_relaxed) > m_mask / 2;
+        }
+
+        void PopAll(std::vector<LogRecord>& out)
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            size_t head = m_head.load(std::memory_order_acquire);
+            for (; tail != head; tail++)
+            {
+                out.push_back(std::move(m_slots[tail & m_mask]));
+            }
+            m_tail.store(tail, std::memory_order_release);
+        }
+
+        bool IsEmpty() const
+        {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_relaxed);
+        }
+
+        // Set when the owning thread exits; the ring is dropped once drained
+        std::atomic<bool> orphaned{ false };
+
+    private:
+        std::vector<LogRecord> m_slots;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_head{ 0 };
+        alignas(64) std::atomic<size_t> m_tail{ 0 };
+    };
+
+    // The calling thread's ring, tagged with the queue generation it belongs to
+    struct ThreadLogRing
+    {
+        std::shared_ptr<AsyncLogQueue::Ring> ring;
+        uint64_t generation = 0;
+
+        ~ThreadLogRing()
+        {
+            if (ring)
+            {
+                ring->orphaned = true;
+            }
+        }
+    };
+
+    static std::atomic<uint64_t> s_queueGeneration{ 0 };
+    static thread_local ThreadLogRing t_logRing;
+
+    AsyncLogQueue::AsyncLogQueue(BatchWriter writer, size_t ringCapacity, std::chrono::milliseconds interval)
+        : m_writer(std::move(writer))
+        , m_ringCapacity(std::max<size_t>(ringCapacity, 2))
+        , m_interval(interval)
+        , m_generation(++s_queueGeneration)
+    {
+        m_thread = std::thread([this]() { Run(); });
+    }
+
+    AsyncLogQueue::~AsyncLogQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        Drain();
+    }
+
+    AsyncLogQueue::Ring& AsyncLogQueue::GetThreadRing()
+    {
+        // First message on this thread (or of a new queue): register a ring
+        if (!t_logRing.ring || t_logRing.generation != m_generation)
+        {
+            if (t_logRing.ring)
+            {
+                t_logRing.ring->orphaned = true;
+            }
+            t_logRing.ring = std::make_shared<Ring>(m_ringCapacity);
+            t_logRing.generation = m_generation;
+
+            std::lock_guard<std::mutex> lock(m_ringsMutex);
+            m_rings.push_back(t_logRing.ring);
+        }
+        return *t_logRing.ring;
+    }
+
+    void AsyncLogQueue::Push(LogLevel level, std::wstring message)
+    {
+        LogRecord record;
+        record.level = level;
+        record.time = std::chrono::system_clock::now();
+        record.message = std::move(message);
+
+        Ring& ring = GetThreadRing();
+        if (!ring.Push(std::move(record)))
+        {
+            // Full: write it out here rather than drop anything
+            Drain();
+            ring.Push(std::move(record));
+        }
+        else if (ring.IsFilling())
+        {
+            m_wake.notify_one();
+        }
+    }
+
+    void AsyncLogQueue::Drain(bool crashing)
+    {
+        std::unique_lock<std::timed_mutex> lock(m_drainMutex, std::defer_lock);
+        if (crashing)
+        {
+            if (!lock.try_lock_for(std::chrono::milliseconds(200)))
+            {
+                return;
+            }
+        }
+        else
+        {
+            lock.lock();
+        }
+        DrainLocked();
+    }
+
+    void AsyncLogQueue::DrainLocked()
+    {
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(m_ringsMutex);
+            rings = m_rings;
+        }
+
+        for (const auto& ring : rings)
+        {
+            ring->PopAll(m_batch);
+        }
+
+        // Rings of finished threads go once they are empty
+        {
+            std::lock_guard<std::mutex> lock(m_ringsMutex);
+            m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(),
+                                         [](const std::shared_ptr<Ring>& ring) { return ring->orphaned && ring->IsEmpty(); }),
+                          m_rings.end());
+        }
+
+        if (m_batch.empty())
+        {
+            return;
+        }
+
+        // Each ring is in order; interleave the threads by time
+        std::stable_sort(m_batch.begin(), m_batch.end(),
+                         [](const LogRecord& a, const LogRecord& b) { return a.time < b.time; });
+
+        try
+        {
+            m_writer(m_batch);
+        }
+        catch (...)
+        {
+            OutputDebugStringW(L"[ZipSpark] Exception writing log batch - dropped\n");
+        }
+        m_batch.clear();
+    }
+
+    void AsyncLogQueue::Run()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait_for(lock, m_interval, [this]() { return m_stopping; });
+                if (m_stopping)
+                {
+                    break;
+                }
+            }
+            Drain();
+        }
+    }
+
+    void Logger::EnableAsync()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue)
+        {
+            return;
+        }
+
+        m_queue = std::make_unique<AsyncLogQueue>([this](std::vector<LogRecord>& batch) { WriteBatch(batch); });
+        InstallCrashHooks();
+    }
+
+    void Logger::WriteBatch(std::vector<LogRecord>& batch)
+    {
+        if (!EnsureInitialized())
+        {
+            return;
+        }
+
+        // One buffer, one write and one flush per batch; the timestamp is
+        // only re-rendered when the second changes
+        std::wstring text;
+        text.reserve(batch.size() * 96);
+
+        std::time_t renderedSecond = -1;
+        wchar_t stamp[32] = {};
+        for (const LogRecord& record : batch)
+        {
+            std::time_t second = std::chrono::system_clock::to_time_t(record.time);
+            if (second != renderedSecond)
+            {
+                std::tm tm;
+                localtime_s(&tm, &second);
+                wcsftime(stamp, sizeof(stamp) / sizeof(stamp[0]), L"[%Y-%m-%d %H:%M:%S] ", &tm);
+                renderedSecond = second;
+            }
+
+            text += stamp;
+            text += L"[";
+            text += GetLevelString(record.level);
+            text += L"] ";
+            text += record.message;
+            text += L"\n";
+        }
+
+        if (IsDebuggerPresent())
+        {
+            OutputDebugStringW(text.c_str());
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_logFile.is_open())
+        {
+            m_logFile << text;
+            m_logFile.flush();
+        }
+    }
+
+    static LPTOP_LEVEL_EXCEPTION_FILTER s_previousExceptionFilter = nullptr;
+    static std::terminate_handler s_previousTerminate = nullptr;
+
+    static LONG WINAPI FlushLogOnCrash(EXCEPTION_POINTERS* exception)
+    {
+        Logger::GetInstance().Flush(true);
+        return s_previousExceptionFilter ? s_previousExceptionFilter(exception) : EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    static void FlushLogOnTerminate()
+    {
+        Logger::GetInstance().Flush(true);
+        if (s_previousTerminate)
+        {
+            s_previousTerminate();
+        }
+        std::abort();
+    }
+
+    void Logger::InstallCrashHooks()
+    {
+        s_previousExceptionFilter = SetUnhandledExceptionFilter(FlushLogOnCrash);
+        s_previousTerminate = std::set_terminate(FlushLogOnTerminate);
+    }
+}
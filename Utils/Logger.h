@@ -7,6 +7,24 @@
 #include <iomanip>
 #include <chrono>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "Utf8.h"
+
+// Levels below this are compiled out of the LOG_ macros
+// (0 Debug, 1 Info, 2 Warning, 3 Error). Debug builds keep everything.
+#ifndef ZIPSPARK_LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define ZIPSPARK_LOG_MIN_LEVEL 0
+#else
+#define ZIPSPARK_LOG_MIN_LEVEL 1
+#endif
+#endif
 
 namespace ZipSpark
 {
@@ -21,6 +39,116 @@ namespace ZipSpark
         Error
     };
 
+    // Argument rendering for Logger::LogFormat
+    inline void AppendLogArg(std::wstring& out, const std::wstring& value) { out += value; }
+    inline void AppendLogArg(std::wstring& out, std::wstring_view value) { out.append(value.data(), value.size()); }
+    inline void AppendLogArg(std::wstring& out, const wchar_t* value) { out += value ? value : L"(null)"; }
+    inline void AppendLogArg(std::wstring& out, wchar_t value) { out += value; }
+    inline void AppendLogArg(std::wstring& out, bool value) { out += value ? L"true" : L"false"; }
+    inline void AppendLogArg(std::wstring& out, const std::filesystem::path& value) { out += value.wstring(); }
+
+    // Narrow strings are UTF-8
+    inline void AppendLogArg(std::wstring& out, std::string_view value) { out += Utf8::ToWide(value); }
+    inline void AppendLogArg(std::wstring& out, const std::string& value) { out += Utf8::ToWide(value); }
+    inline void AppendLogArg(std::wstring& out, const char* value) { out += value ? Utf8::ToWide(value) : L"(null)"; }
+
+    template <typename T>
+    std::enable_if_t<std::is_arithmetic_v<T>> AppendLogArg(std::wstring& out, T value)
+    {
+        out += std::to_wstring(value);
+    }
+
+    // Replace each "{}" in format with the next argument
+    inline void FormatLogMessage(std::wstring& out, std::wstring_view format)
+    {
+        out.append(format.data(), format.size());
+    }
+
+    template <typename T, typename... Rest>
+    void FormatLogMessage(std::wstring& out, std::wstring_view format, const T& first, const Rest&... rest)
+    {
+        size_t placeholder = format.find(L"{}");
+        if (placeholder == std::wstring_view::npos)
+        {
+            out.append(format.data(), format.size());
+            return;
+        }
+        out.append(format.data(), placeholder);
+        AppendLogArg(out, first);
+        FormatLogMessage(out, format.substr(placeholder + 2), rest...);
+    }
+
+    /// <summary>
+    /// One queued log message
+    /// </summary>
+    struct LogRecord
+    {
+        LogLevel level = LogLevel::Info;
+        std::chrono::system_clock::time_point time;
+        std::wstring message;
+    };
+
+    /// <summary>
+    /// Lock-free hand-off of log messages to a background flusher.
+    /// Each producing thread owns a single-producer ring (registered on its
+    /// first message), so logging is a move into a slot and an atomic store.
+    /// The flusher thread drains all rings at a fixed interval, or early when
+    /// a ring fills up, and hands the batch to the writer in time order.
+    /// </summary>
+    class AsyncLogQueue
+    {
+    public:
+        using BatchWriter = std::function<void(std::vector<LogRecord>& batch)>;
+
+        AsyncLogQueue(BatchWriter writer, size_t ringCapacity = 4096,
+                      std::chrono::milliseconds interval = std::chrono::milliseconds(50));
+
+        /// <summary>
+        /// Stops the flusher after a final drain
+        /// </summary>
+        ~AsyncLogQueue();
+
+        /// <summary>
+        /// Queue a message. A full ring is drained on the calling thread
+        /// rather than losing the message.
+        /// </summary>
+        void Push(LogLevel level, std::wstring message);
+
+        /// <summary>
+        /// Write out everything queued so far from the calling thread.
+        /// crashing gives up after a short wait if the flusher holds the
+        /// queue (it may be the thread that crashed).
+        /// </summary>
+        void Drain(bool crashing = false);
+
+    private:
+        class Ring;
+        friend struct ThreadLogRing;
+
+        AsyncLogQueue(const AsyncLogQueue&) = delete;
+        AsyncLogQueue& operator=(const AsyncLogQueue&) = delete;
+
+        Ring& GetThreadRing();
+        void Run();
+        void DrainLocked();
+
+        BatchWriter m_writer;
+        size_t m_ringCapacity;
+        std::chrono::milliseconds m_interval;
+        uint64_t m_generation;
+
+        std::mutex m_ringsMutex;
+        std::vector<std::shared_ptr<Ring>> m_rings;
+
+        std::timed_mutex m_drainMutex;
+        std::vector<LogRecord> m_batch;
+
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wake;
+        bool m_stopping = false;
+        std::thread m_thread;
+    };
+
     /// <summary>
     /// Simple structured logger for ZipSpark
     /// Creates per-run log files with timestamps
@@ -69,7 +197,8 @@ namespace ZipSpark
                     return;
                 }
 
-                // Generate timestamped log file name
+                // Generate timestamped log file name; the process id keeps the
+                // app and its extraction workers out of each other's files
                 auto now = std::chrono::system_clock::now();
                 auto time = std::chrono::system_clock::to_time_t(now);
                 std::tm tm;
@@ -78,6 +207,7 @@ namespace ZipSpark
                 std::wstringstream filename;
                 filename << logDirectory << L"\\ZipSpark_"
                     << std::put_time(&tm, L"%Y%m%d_%H%M%S")
+                    << L"_" << GetCurrentProcessId()
                     << L".log";
 
                 m_logFilePath = filename.str();
@@ -121,6 +251,56 @@ namespace ZipSpark
             }
         }
 
+        /// <summary>
+        /// Switch to asynchronous logging: messages are queued per thread and
+        /// written in batches by a background thread. Errors, crashes and
+        /// shutdown drain the queue so nothing logged before them is lost.
+        /// </summary>
+        void EnableAsync();
+
+        /// <summary>
+        /// Write out queued messages (no-op when logging synchronously)
+        /// </summary>
+        void Flush(bool crashing = false)
+        {
+            if (m_queue)
+            {
+                m_queue->Drain(crashing);
+            }
+        }
+
+        /// <summary>
+        /// Whether messages of this level are currently written. The LOG_
+        /// macros test this before evaluating their arguments.
+        /// </summary>
+        static bool IsEnabled(LogLevel level)
+        {
+            return static_cast<int>(level) >= s_threshold.load(std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Turn logging on or off (Settings::enableLogging)
+        /// </summary>
+        void SetEnabled(bool enabled)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_enabled = enabled;
+            s_threshold.store(enabled ? static_cast<int>(m_minLevel) : LOG_THRESHOLD_OFF, std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Lowest level written while logging is enabled
+        /// </summary>
+        void SetMinLevel(LogLevel level)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_minLevel = level;
+            if (m_enabled)
+            {
+                s_threshold.store(static_cast<int>(level), std::memory_order_relaxed);
+            }
+        }
+
         /// <summary>
         /// Get the path to the current log file
         /// </summary>
@@ -132,46 +312,26 @@ namespace ZipSpark
         /// <summary>
         /// Log a message with specified severity
         /// </summary>
-        void Log(LogLevel level, const std::wstring& message)
+        void Log(LogLevel level, std::wstring message)
         {
+            // Async: the flusher does the formatting and the debugger output
+            if (m_queue)
+            {
+                m_queue->Push(level, std::move(message));
+                if (level == LogLevel::Error)
+                {
+                    m_queue->Drain();
+                }
+                return;
+            }
+
             // SAFETY: Use OutputDebugString first for emergency debugging
             std::wstring debugMsg = L"[ZipSpark] " + GetLevelString(level) + L": " + message + L"\n";
             OutputDebugStringW(debugMsg.c_str());
             
-            // Auto-initialize if not initialized (SIMPLIFIED: temp directory only)
-            if (!m_isInitialized)
+            if (!EnsureInitialized())
             {
-                try
-                {
-                    OutputDebugStringW(L"[ZipSpark] Auto-initializing logger...\n");
-                    
-                    // SIMPLIFIED: Use temp directory only (more reliable than SHGetKnownFolderPath)
-                    wchar_t tempPath[MAX_PATH];
-                    DWORD result = GetTempPathW(MAX_PATH, tempPath);
-                    
-                    if (result == 0 || result > MAX_PATH)
-                    {
-                        OutputDebugStringW(L"[ZipSpark] GetTempPathW failed\n");
-                        return; // Silent failure - at least OutputDebugString worked
-                    }
-                    
-                    std::wstring logDir = std::wstring(tempPath) + L"ZipSpark\\Logs";
-                    OutputDebugStringW((L"[ZipSpark] Using temp log directory: " + logDir + L"\n").c_str());
-                    
-                    Initialize(logDir);
-                    
-                    // If still not initialized after trying, give up silently
-                    if (!m_isInitialized)
-                    {
-                        OutputDebugStringW(L"[ZipSpark] Logger initialization failed, logging disabled\n");
-                        return;
-                    }
-                }
-                catch (...)
-                {
-                    OutputDebugStringW(L"[ZipSpark] Exception during auto-initialization\n");
-                    return; // Silent failure
-                }
+                return;
             }
 
             try
@@ -201,42 +361,58 @@ namespace ZipSpark
             }
         }
 
+        /// <summary>
+        /// Log a message built from a format with "{}" placeholders; the
+        /// arguments are only rendered here, after the level check
+        /// </summary>
+        template <typename... Args>
+        void LogFormat(LogLevel level, std::wstring_view format, const Args&... args)
+        {
+            std::wstring message;
+            message.reserve(format.size() + 32 * sizeof...(Args));
+            FormatLogMessage(message, format, args...);
+            Log(level, std::move(message));
+        }
+
         /// <summary>
         /// Log debug message
         /// </summary>
-        void Debug(const std::wstring& message)
+        void Debug(std::wstring message)
         {
-            Log(LogLevel::Debug, message);
+            Log(LogLevel::Debug, std::move(message));
         }
 
         /// <summary>
         /// Log info message
         /// </summary>
-        void Info(const std::wstring& message)
+        void Info(std::wstring message)
         {
-            Log(LogLevel::Info, message);
+            Log(LogLevel::Info, std::move(message));
         }
 
         /// <summary>
         /// Log warning message
         /// </summary>
-        void Warning(const std::wstring& message)
+        void Warning(std::wstring message)
         {
-            Log(LogLevel::Warning, message);
+            Log(LogLevel::Warning, std::move(message));
         }
 
         /// <summary>
         /// Log error message
         /// </summary>
-        void Error(const std::wstring& message)
+        void Error(std::wstring message)
         {
-            Log(LogLevel::Error, message);
+            Log(LogLevel::Error, std::move(message));
         }
 
         ~Logger()
         {
             try
             {
+                // Final drain before the file goes away
+                m_queue.reset();
+
                 if (m_logFile.is_open())
                 {
                     auto now = std::chrono::system_clock::now();
@@ -273,15 +449,87 @@ namespace ZipSpark
             }
         }
 
+        // Auto-initialize on first use; false if there is nowhere to log to
+        bool EnsureInitialized()
+        {
+            // Auto-initialize if not initialized (SIMPLIFIED: temp directory only)
+            if (!m_isInitialized)
+            {
+                try
+                {
+                    OutputDebugStringW(L"[ZipSpark] Auto-initializing logger...\n");
+                    
+                    // SIMPLIFIED: Use temp directory only (more reliable than SHGetKnownFolderPath)
+                    wchar_t tempPath[MAX_PATH];
+                    DWORD result = GetTempPathW(MAX_PATH, tempPath);
+                    
+                    if (result == 0 || result > MAX_PATH)
+                    {
+                        OutputDebugStringW(L"[ZipSpark] GetTempPathW failed\n");
+                        return false; // Silent failure - at least OutputDebugString worked
+                    }
+                    
+                    std::wstring logDir = std::wstring(tempPath) + L"ZipSpark\\Logs";
+                    OutputDebugStringW((L"[ZipSpark] Using temp log directory: " + logDir + L"\n").c_str());
+                    
+                    Initialize(logDir);
+                    
+                    // If still not initialized after trying, give up silently
+                    if (!m_isInitialized)
+                    {
+                        OutputDebugStringW(L"[ZipSpark] Logger initialization failed, logging disabled\n");
+                        return false;
+                    }
+                }
+                catch (...)
+                {
+                    OutputDebugStringW(L"[ZipSpark] Exception during auto-initialization\n");
+                    return false; // Silent failure
+                }
+            }
+            return true;
+        }
+
+        // Format and write one batch from the async queue
+        void WriteBatch(std::vector<LogRecord>& batch);
+
+        // Drain the queue on unhandled exceptions and std::terminate
+        static void InstallCrashHooks();
+
+        static constexpr int LOG_THRESHOLD_OFF = static_cast<int>(LogLevel::Error) + 1;
+
+        // Lowest enabled level, or LOG_THRESHOLD_OFF; read without locking by IsEnabled
+        inline static std::atomic<int> s_threshold{ static_cast<int>(LogLevel::Debug) };
+
         std::wofstream m_logFile;
         std::wstring m_logFilePath;
         std::mutex m_mutex;
         bool m_isInitialized = false;
+        bool m_enabled = true;
+        LogLevel m_minLevel = LogLevel::Debug;
+        std::unique_ptr<AsyncLogQueue> m_queue;
     };
 }
 
-// Convenience macros for logging
-#define LOG_DEBUG(msg) ZipSpark::Logger::GetInstance().Debug(msg)
-#define LOG_INFO(msg) ZipSpark::Logger::GetInstance().Info(msg)
-#define LOG_WARNING(msg) ZipSpark::Logger::GetInstance().Warning(msg)
-#define LOG_ERROR(msg) ZipSpark::Logger::GetInstance().Error(msg)
+// Convenience macros for logging. The message expression is only evaluated
+// when the level is enabled, and levels below ZIPSPARK_LOG_MIN_LEVEL compile
+// to nothing. The F forms take a format with "{}" placeholders plus arguments,
+// so not even the concatenation happens for a disabled level.
+#define ZIPSPARK_LOG_IF(level, call) \
+    do \
+    { \
+        if (static_cast<int>(level) >= ZIPSPARK_LOG_MIN_LEVEL && ZipSpark::Logger::IsEnabled(level)) \
+        { \
+            call; \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(msg) ZIPSPARK_LOG_IF(ZipSpark::LogLevel::Debug, ZipSpark::Logger::GetInstance().Debug(msg))
+#define LOG_INFO(msg) ZIPSPARK_LOG_IF(ZipSpark::LogLevel::Info, ZipSpark::Logger::GetInstance().Info(msg))
+#define LOG_WARNING(msg) ZIPSPARK_LOG_IF(ZipSpark::LogLevel::Warning, ZipSpark::Logger::GetInstance().Warning(msg))
+#define LOG_ERROR(msg) ZIPSPARK_LOG_IF(ZipSpark::LogLevel::Error, ZipSpark::Logger::GetInstance().Error(msg))
+
+#define LOG_DEBUGF(...) ZIPSPARK_LOG_IF(ZipSpark::LogLevel::Debug, ZipSpark::Logger::GetInstance().LogFormat(ZipSpark::LogLevel::Debug, __VA_ARGS__))
+#define LOG_INFOF(...) ZIPSPARK_LOG_IF(ZipSpark::LogLevel::Info, ZipSpark::Logger::GetInstance().LogFormat(ZipSpark::LogLevel::Info, __VA_ARGS__))
+#define LOG_WARNINGF(...) ZIPSPARK_LOG_IF(ZipSpark::LogLevel::Warning, ZipSpark::Logger::GetInstance().LogFormat(ZipSpark::LogLevel::Warning, __VA_ARGS__))
+#define LOG_ERRORF(...) ZIPSPARK_LOG_IF(ZipSpark::LogLevel::Error, ZipSpark::Logger::GetInstance().LogFormat(ZipSpark::LogLevel::Error, __VA_ARGS__))
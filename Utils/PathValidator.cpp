@@ -0,0 +1,138 @@
+// Portable: builds without the precompiled header (ZipSpark.PathBench compiles it too)
+#include "PathValidator.h"
+
+namespace fs = std::filesystem;
+
+namespace ZipSpark {
+
+static bool IsSeparator(wchar_t ch)
+{
+    return ch == L'/' || ch == L'\\';
+}
+
+// Characters that are invalid in Windows file names: < > : " / \ | ? * and control characters
+static bool IsInvalidNameChar(wchar_t ch)
+{
+    return ch < 32 || ch == L'<' || ch == L'>' || ch == L':' || ch == L'"' ||
+           ch == L'|' || ch == L'?' || ch == L'*';
+}
+
+PathValidator::PathValidator(const fs::path& destination)
+{
+    // The only filesystem access: resolve the destination once per job
+    std::error_code ec;
+    fs::path canonical = fs::weakly_canonical(destination, ec);
+    m_root = (ec ? destination.lexically_normal() : canonical).wstring();
+
+    while (m_root.size() > 1 && IsSeparator(m_root.back()) && m_root[m_root.size() - 2] != L':')
+    {
+        m_root.pop_back();
+    }
+}
+
+// CON, PRN, AUX, NUL, COM1-9 and LPT1-9, with or without an extension
+static bool IsReservedDeviceName(std::wstring_view name)
+{
+    std::wstring_view stem = name.substr(0, name.find(L'.'));
+    auto upper = [](wchar_t ch) { return (ch >= L'a' && ch <= L'z') ? static_cast<wchar_t>(ch - 32) : ch; };
+    auto equals = [&](const wchar_t* reserved, size_t length) {
+        if (stem.size() != length) return false;
+        for (size_t i = 0; i < length; i++)
+        {
+            if (upper(stem[i]) != reserved[i]) return false;
+        }
+        return true;
+    };
+
+    if (equals(L"CON", 3) || equals(L"PRN", 3) || equals(L"AUX", 3) || equals(L"NUL", 3))
+    {
+        return true;
+    }
+    if (stem.size() == 4 && stem[3] >= L'1' && stem[3] <= L'9')
+    {
+        stem = stem.substr(0, 3);
+        return equals(L"COM", 3) || equals(L"LPT", 3);
+    }
+    return false;
+}
+
+bool PathValidator::Resolve(std::wstring_view entryPath, std::wstring& relativePath) const
+{
+    relativePath.clear();
+
+    // Absolute paths and UNC/device prefixes ("/x", "\\server\share", "\\?\C:")
+    if (!entryPath.empty() && IsSeparator(entryPath.front()))
+    {
+        return false;
+    }
+
+    // Drive letters ("C:", "C:foo")
+    if (entryPath.size() >= 2 && entryPath[1] == L':' &&
+        ((entryPath[0] >= L'A' && entryPath[0] <= L'Z') || (entryPath[0] >= L'a' && entryPath[0] <= L'z')))
+    {
+        return false;
+    }
+
+    size_t i = 0;
+    const size_t length = entryPath.size();
+    while (i < length)
+    {
+        size_t start = i;
+        while (i < length && !IsSeparator(entryPath[i]))
+        {
+            i++;
+        }
+        std::wstring_view component = entryPath.substr(start, i - start);
+        i++; // Skip the separator
+
+        if (component.empty())
+        {
+            continue; // "a//b"
+        }
+
+        // Components made only of dots and spaces: "." is a no-op, anything else
+        // ("..", "...", ". .") is either traversal or something Win32 strips into it
+        if (component.find_first_not_of(L". ") == std::wstring_view::npos)
+        {
+            if (component == L".")
+            {
+                continue;
+            }
+            return false;
+        }
+
+        // Win32 silently drops trailing dots and spaces; the NT API does not,
+        // and Explorer can't open names that keep them
+        component = component.substr(0, component.find_last_not_of(L". ") + 1);
+
+        if (!relativePath.empty())
+        {
+            relativePath.push_back(L'\\');
+        }
+
+        if (IsReservedDeviceName(component))
+        {
+            relativePath.push_back(L'_');
+        }
+
+        for (wchar_t ch : component)
+        {
+            relativePath.push_back(IsInvalidNameChar(ch) ? L'_' : ch);
+        }
+    }
+
+    // Nothing left after normalization (e.g. "./")
+    return !relativePath.empty();
+}
+
+std::wstring PathValidator::GetFullPath(const std::wstring& relativePath) const
+{
+    std::wstring fullPath = m_root;
+    if (!fullPath.empty() && !IsSeparator(fullPath.back()))
+    {
+        fullPath.push_back(L'\\');
+    }
+    return fullPath + relativePath;
+}
+
+} // namespace ZipSpark
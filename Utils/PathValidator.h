@@ -0,0 +1,34 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Lexical Zip Slip guard.
+/// The destination is canonicalized once per job; entry paths are then
+/// normalized and checked in a single pass without touching the disk.
+/// Rejects "..", absolute paths, drive letters and UNC prefixes, and rewrites
+/// names Win32 can't round-trip (invalid characters, trailing dots/spaces,
+/// device names) since files are created through the NT API.
+/// </summary>
+class PathValidator
+{
+public:
+    explicit PathValidator(const std::filesystem::path& destination);
+
+    // Normalize an archive entry path into a '\' separated path relative to
+    // the destination. Returns false if the entry would land outside it.
+    bool Resolve(std::wstring_view entryPath, std::wstring& relativePath) const;
+
+    // Destination root joined with a path returned by Resolve
+    std::wstring GetFullPath(const std::wstring& relativePath) const;
+
+    const std::wstring& GetRoot() const { return m_root; }
+
+private:
+    std::wstring m_root; // Canonical destination without trailing separator
+};
+
+} // namespace ZipSpark
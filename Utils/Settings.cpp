@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Settings.h"
+#include "EventLog.h"
 #include "Logger.h"
 #include <filesystem>
 #include <fstream>
@@ -78,10 +79,17 @@ void Settings::Load()
                     enableLogging = (value == L"true");
                 else if (key == L"bufferSize")
                     bufferSize = std::stoul(value);
+                else if (key == L"indexCacheBudget")
+                    indexCacheBudget = std::stoull(value);
+                else if (key == L"stallTimeoutSeconds")
+                    stallTimeoutSeconds = std::stoul(value);
+                else if (key == L"extractionDeadlineSeconds")
+                    extractionDeadlineSeconds = std::stoul(value);
             }
         }
         
         file.close();
+        Logger::GetInstance().SetEnabled(enableLogging);
         LOG_INFO(L"Settings loaded successfully");
     }
     catch (const std::exception& e)
@@ -113,10 +121,18 @@ void Settings::Save()
         file << L"  \"closeAfterExtraction\": " << (closeAfterExtraction ? L"true" : L"false") << L",\n";
         file << L"  \"theme\": " << static_cast<int>(theme) << L",\n";
         file << L"  \"enableLogging\": " << (enableLogging ? L"true" : L"false") << L",\n";
-        file << L"  \"bufferSize\": " << bufferSize << L"\n";
+        file << L"  \"bufferSize\": " << bufferSize << L",\n";
+        file << L"  \"indexCacheBudget\": " << indexCacheBudget << L",\n";
+        file << L"  \"stallTimeoutSeconds\": " << stallTimeoutSeconds << L",\n";
+        file << L"  \"extractionDeadlineSeconds\": " << extractionDeadlineSeconds << L"\n";
         file << L"}\n";
         
         file.close();
+        Logger::GetInstance().SetEnabled(enableLogging);
+        if (!enableLogging)
+        {
+            EventLog::GetInstance().Close();
+        }
         LOG_INFO(L"Settings saved successfully");
     }
     catch (const std::exception& e)
@@ -136,6 +152,9 @@ void Settings::ResetToDefaults()
     theme = winrt::Microsoft::UI::Xaml::ElementTheme::Default;
     enableLogging = true;
     bufferSize = 65536;
+    indexCacheBudget = 256ull * 1024 * 1024;
+    stallTimeoutSeconds = 120;
+    extractionDeadlineSeconds = 0;
     
     Save();
     LOG_INFO(L"Settings reset to defaults");
@@ -35,6 +35,9 @@ public:
     // Advanced settings
     bool enableLogging = true;
     uint32_t bufferSize = 65536; // 64 KB
+    uint64_t indexCacheBudget = 256ull * 1024 * 1024; // 256 MB of cached archive indexes
+    uint32_t stallTimeoutSeconds = 120; // Stop an extraction with no progress this long (0 = never)
+    uint32_t extractionDeadlineSeconds = 0; // Stop any extraction running this long (0 = no limit)
 
     /// <summary>
     /// Load settings from file
@@ -0,0 +1,349 @@
+#include "Utf8.h"
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ZIPSPARK_UTF8_SSE2 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define ZIPSPARK_UTF8_NEON 1
+#endif
+
+namespace ZipSpark {
+
+constexpr uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+// CP437 bytes 0x80-0xFF; the lower half is ASCII
+static const uint16_t CP437_HIGH[128] =
+{
+    0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7, 0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5,
+    0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9, 0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192,
+    0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA, 0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB,
+    0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556, 0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+    0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F, 0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+    0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B, 0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+    0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4, 0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229,
+    0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
+};
+
+// Widen the leading ASCII run of in into out; returns its length
+static size_t WidenAscii(const unsigned char* in, size_t size, wchar_t* out)
+{
+    size_t i = 0;
+
+#if defined(ZIPSPARK_UTF8_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        if (_mm_movemask_epi8(bytes) != 0)
+        {
+            break; // A byte >= 0x80 in this block; finish it below
+        }
+
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), high);
+        }
+        else
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 12), _mm_unpackhi_epi16(high, zero));
+        }
+    }
+#elif defined(ZIPSPARK_UTF8_NEON)
+    for (; i + 16 <= size; i += 16)
+    {
+        uint8x16_t bytes = vld1q_u8(in + i);
+        if (vmaxvq_u8(bytes) >= 0x80)
+        {
+            break;
+        }
+
+        uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+        uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            vst1q_u16(reinterpret_cast<uint16_t*>(out + i), low);
+            vst1q_u16(reinterpret_cast<uint16_t*>(out + i + 8), high);
+        }
+        else
+        {
+            vst1q_u32(reinterpret_cast<uint32_t*>(out + i), vmovl_u16(vget_low_u16(low)));
+            vst1q_u32(reinterpret_cast<uint32_t*>(out + i + 4), vmovl_u16(vget_high_u16(low)));
+            vst1q_u32(reinterpret_cast<uint32_t*>(out + i + 8), vmovl_u16(vget_low_u16(high)));
+            vst1q_u32(reinterpret_cast<uint32_t*>(out + i + 12), vmovl_u16(vget_high_u16(high)));
+        }
+    }
+#endif
+
+    for (; i < size && in[i] < 0x80; i++)
+    {
+        out[i] = static_cast<wchar_t>(in[i]);
+    }
+    return i;
+}
+
+// Length of the leading ASCII run (same vector scan, no output)
+static size_t AsciiPrefix(const unsigned char* in, size_t size)
+{
+    size_t i = 0;
+
+#if defined(ZIPSPARK_UTF8_SSE2)
+    for (; i + 16 <= size; i += 16)
+    {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))) != 0)
+        {
+            break;
+        }
+    }
+#elif defined(ZIPSPARK_UTF8_NEON)
+    for (; i + 16 <= size; i += 16)
+    {
+        if (vmaxvq_u8(vld1q_u8(in + i)) >= 0x80)
+        {
+            break;
+        }
+    }
+#endif
+
+    while (i < size && in[i] < 0x80)
+    {
+        i++;
+    }
+    return i;
+}
+
+// Decode one non-ASCII sequence (Unicode well-formed table: no overlongs,
+// surrogates or code points above U+10FFFF). Returns the bytes consumed; an
+// invalid sequence consumes its maximal valid prefix (at least one byte)
+// and decodes to U+FFFD.
+static size_t DecodeSequence(const unsigned char* in, size_t size, uint32_t& codePoint, bool& valid)
+{
+    unsigned char lead = in[0];
+    size_t length;
+    unsigned char secondMin = 0x80;
+    unsigned char secondMax = 0xBF;
+
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+        codePoint = lead & 0x1F;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        codePoint = lead & 0x0F;
+        if (lead == 0xE0) secondMin = 0xA0;
+        if (lead == 0xED) secondMax = 0x9F;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        codePoint = lead & 0x07;
+        if (lead == 0xF0) secondMin = 0x90;
+        if (lead == 0xF4) secondMax = 0x8F;
+    }
+    else
+    {
+        valid = false;
+        codePoint = REPLACEMENT_CHARACTER;
+        return 1;
+    }
+
+    for (size_t i = 1; i < length; i++)
+    {
+        unsigned char min = i == 1 ? secondMin : 0x80;
+        unsigned char max = i == 1 ? secondMax : 0xBF;
+        if (i >= size || in[i] < min || in[i] > max)
+        {
+            valid = false;
+            codePoint = REPLACEMENT_CHARACTER;
+            return i;
+        }
+        codePoint = (codePoint << 6) | (in[i] & 0x3F);
+    }
+
+    valid = true;
+    return length;
+}
+
+// Store a code point; returns the number of wchar_t written
+static size_t EmitCodePoint(uint32_t codePoint, wchar_t* out)
+{
+    if constexpr (sizeof(wchar_t) == 2)
+    {
+        if (codePoint >= 0x10000)
+        {
+            codePoint -= 0x10000;
+            out[0] = static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+            out[1] = static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+            return 2;
+        }
+    }
+    out[0] = static_cast<wchar_t>(codePoint);
+    return 1;
+}
+
+bool Utf8::ToWide(std::string_view input, std::wstring& output)
+{
+    // Every sequence yields no more wchar_t than it has bytes: one pass into
+    // a buffer of input size, trimmed at the end (resize keeps the capacity)
+    output.resize(input.size());
+
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(input.data());
+    size_t size = input.size();
+    wchar_t* out = &output[0];
+    size_t read = 0;
+    size_t written = 0;
+    bool allValid = true;
+
+    while (read < size)
+    {
+        size_t run = WidenAscii(in + read, size - read, out + written);
+        read += run;
+        written += run;
+        if (read == size)
+        {
+            break;
+        }
+
+        uint32_t codePoint;
+        bool valid;
+        read += DecodeSequence(in + read, size - read, codePoint, valid);
+        written += EmitCodePoint(codePoint, out + written);
+        allValid = allValid && valid;
+    }
+
+    output.resize(written);
+    return allValid;
+}
+
+std::wstring Utf8::ToWide(std::string_view input)
+{
+    std::wstring output;
+    ToWide(input, output);
+    return output;
+}
+
+bool Utf8::IsValid(std::string_view input)
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(input.data());
+    size_t size = input.size();
+    size_t read = 0;
+
+    while (read < size)
+    {
+        read += AsciiPrefix(in + read, size - read);
+        if (read == size)
+        {
+            break;
+        }
+
+        uint32_t codePoint;
+        bool valid;
+        read += DecodeSequence(in + read, size - read, codePoint, valid);
+        if (!valid)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Utf8::FromWide(std::wstring_view input, std::string& output)
+{
+    output.clear();
+    output.reserve(input.size());
+
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        uint32_t codePoint = static_cast<uint32_t>(input[i]);
+        if (codePoint < 0x80)
+        {
+            output.push_back(static_cast<char>(codePoint));
+            continue;
+        }
+
+        if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+        {
+            // Only a high surrogate followed by a low one is a pair
+            uint32_t next = i + 1 < input.size() ? static_cast<uint32_t>(input[i + 1]) : 0;
+            if (sizeof(wchar_t) == 2 && codePoint <= 0xDBFF && next >= 0xDC00 && next <= 0xDFFF)
+            {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (next - 0xDC00);
+                i++;
+            }
+            else
+            {
+                codePoint = REPLACEMENT_CHARACTER;
+            }
+        }
+        else if (codePoint > 0x10FFFF)
+        {
+            codePoint = REPLACEMENT_CHARACTER;
+        }
+
+        if (codePoint < 0x800)
+        {
+            output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        }
+        else
+        {
+            if (codePoint < 0x10000)
+            {
+                output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            }
+            else
+            {
+                output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            }
+            output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        }
+        output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+std::string Utf8::FromWide(std::wstring_view input)
+{
+    std::string output;
+    FromWide(input, output);
+    return output;
+}
+
+void Utf8::Cp437ToWide(std::string_view input, std::wstring& output)
+{
+    output.resize(input.size());
+
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(input.data());
+    size_t size = input.size();
+    wchar_t* out = &output[0];
+    size_t i = 0;
+
+    while (i < size)
+    {
+        i += WidenAscii(in + i, size - i, out + i);
+        if (i < size)
+        {
+            out[i] = static_cast<wchar_t>(CP437_HIGH[in[i] - 0x80]);
+            i++;
+        }
+    }
+}
+
+void Utf8::DecodeEntryName(std::string_view name, std::wstring& output)
+{
+    // Decoding validates as it goes; only names that fail are decoded again
+    if (!ToWide(name, output))
+    {
+        Cp437ToWide(name, output);
+    }
+}
+
+} // namespace ZipSpark
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace ZipSpark {
+
+/// <summary>
+/// Portable text transcoding for archive entry names (no Win32 dependency).
+/// Runs of ASCII are validated and widened 16 bytes at a time (SSE2 or NEON).
+/// Invalid UTF-8 decodes to U+FFFD per maximal invalid subsequence, so a name
+/// always converts the same way regardless of the system code page. Outputs
+/// are passed in so callers can reuse one buffer across entries; wchar_t is
+/// UTF-16 on Windows and UTF-32 elsewhere.
+/// </summary>
+class Utf8
+{
+public:
+    // Decode UTF-8 into output (replacing its contents).
+    // Returns false if invalid sequences were replaced with U+FFFD.
+    static bool ToWide(std::string_view input, std::wstring& output);
+
+    // Encode into UTF-8 (replacing the contents of output); unpaired
+    // surrogates become U+FFFD
+    static void FromWide(std::wstring_view input, std::string& output);
+
+    static bool IsValid(std::string_view input);
+
+    // Legacy ZIP names (no UTF-8 flag) are IBM code page 437
+    static void Cp437ToWide(std::string_view input, std::wstring& output);
+
+    // Entry name as stored: UTF-8 when it is valid UTF-8, CP437 otherwise
+    static void DecodeEntryName(std::string_view name, std::wstring& output);
+
+    // Convenience forms allocating a new string
+    static std::wstring ToWide(std::string_view input);
+    static std::string FromWide(std::wstring_view input);
+};
+
+} // namespace ZipSpark
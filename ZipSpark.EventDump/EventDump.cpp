@@ -0,0 +1,224 @@
+// ZipSpark.EventDump: renders a binary event log (.zsev) as text or JSON.
+// Usage: ZipSpark.EventDump [--json] <file.zsev>
+// Portable: builds with any C++17 compiler.
+#include "../Utils/EventLogFormat.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace ZipSpark::EventLogFormat;
+
+namespace {
+
+struct EventLogFile
+{
+    FileHeader header;
+    std::vector<EventRecord> events;
+    std::unordered_map<uint64_t, std::string> strings;
+};
+
+bool ReadEventLog(const char* path, EventLogFile& log, std::string& error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        error = "cannot open file";
+        return false;
+    }
+
+    if (!file.read(reinterpret_cast<char*>(&log.header), sizeof(log.header)) || log.header.magic != MAGIC)
+    {
+        error = "not a ZipSpark event log";
+        return false;
+    }
+    if (log.header.version != VERSION || log.header.recordSize != sizeof(EventRecord))
+    {
+        error = "unsupported event log version " + std::to_string(log.header.version);
+        return false;
+    }
+
+    // A log cut short (e.g. by a crash) ends with a partial record; keep what is whole
+    EventRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record)))
+    {
+        if (record.eventId != static_cast<uint16_t>(EventId::String))
+        {
+            log.events.push_back(record);
+            continue;
+        }
+
+        size_t paddedSize = (record.arg1 + sizeof(EventRecord) - 1) / sizeof(EventRecord) * sizeof(EventRecord);
+        std::string text(paddedSize, '\0');
+        if (!file.read(&text[0], static_cast<std::streamsize>(paddedSize)))
+        {
+            break;
+        }
+        text.resize(static_cast<size_t>(record.arg1));
+        log.strings[record.arg0] = std::move(text);
+    }
+
+    // Threads append in batches; put everything back in time order
+    std::stable_sort(log.events.begin(), log.events.end(), [](const EventRecord& a, const EventRecord& b) {
+        return a.timestamp < b.timestamp;
+    });
+    return true;
+}
+
+const EventDescription* Describe(uint16_t eventId)
+{
+    return eventId < static_cast<uint16_t>(EventId::Count) ? &EVENT_DESCRIPTIONS[eventId] : nullptr;
+}
+
+std::string LookupString(const EventLogFile& log, uint64_t id)
+{
+    auto it = log.strings.find(id);
+    return it != log.strings.end() ? it->second : "<string " + std::to_string(id) + ">";
+}
+
+std::string JsonEscape(const std::string& text)
+{
+    std::string out;
+    out.reserve(text.size() + 2);
+    for (unsigned char c : text)
+    {
+        switch (c)
+        {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            }
+            else
+            {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+    return out;
+}
+
+void WriteText(const EventLogFile& log)
+{
+    std::printf("# start %" PRIu64 " ns (Unix), %zu events, %zu strings\n",
+                log.header.startTime, log.events.size(), log.strings.size());
+
+    for (const EventRecord& event : log.events)
+    {
+        std::printf("%14.6f ms  job %-4u t%-3u ", event.timestamp / 1e6, event.jobId, event.thread);
+
+        const EventDescription* description = Describe(event.eventId);
+        if (!description)
+        {
+            std::printf("Event%u %" PRIu64 " %" PRIu64 "\n", event.eventId, event.arg0, event.arg1);
+            continue;
+        }
+
+        std::printf("%-13s %s=", description->name, description->arg0);
+        if (description->arg0IsString)
+        {
+            std::printf("\"%s\"", LookupString(log, event.arg0).c_str());
+        }
+        else
+        {
+            std::printf("%" PRIu64, event.arg0);
+        }
+        if (description->arg1)
+        {
+            std::printf(" %s=%" PRId64, description->arg1, static_cast<int64_t>(event.arg1));
+        }
+        std::printf("\n");
+    }
+}
+
+void WriteJson(const EventLogFile& log)
+{
+    std::printf("{\n  \"startTime\": %" PRIu64 ",\n  \"events\": [", log.header.startTime);
+
+    bool first = true;
+    for (const EventRecord& event : log.events)
+    {
+        std::printf("%s\n    { \"time\": %" PRIu64 ", \"job\": %u, \"thread\": %u", first ? "" : ",",
+                    event.timestamp, event.jobId, event.thread);
+        first = false;
+
+        const EventDescription* description = Describe(event.eventId);
+        if (!description)
+        {
+            std::printf(", \"event\": %u, \"arg0\": %" PRIu64 ", \"arg1\": %" PRIu64 " }", event.eventId, event.arg0,
+                        event.arg1);
+            continue;
+        }
+
+        std::printf(", \"event\": \"%s\", \"%s\": ", description->name, description->arg0);
+        if (description->arg0IsString)
+        {
+            std::printf("\"%s\"", JsonEscape(LookupString(log, event.arg0)).c_str());
+        }
+        else
+        {
+            std::printf("%" PRIu64, event.arg0);
+        }
+        if (description->arg1)
+        {
+            std::printf(", \"%s\": %" PRId64, description->arg1, static_cast<int64_t>(event.arg1));
+        }
+        std::printf(" }");
+    }
+
+    std::printf("\n  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bool json = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+
+    if (!path)
+    {
+        std::fprintf(stderr, "Usage: ZipSpark.EventDump [--json] <file.zsev>\n");
+        return 2;
+    }
+
+    EventLogFile log;
+    std::string error;
+    if (!ReadEventLog(path, log, error))
+    {
+        std::fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return 1;
+    }
+
+    if (json)
+    {
+        WriteJson(log);
+    }
+    else
+    {
+        WriteText(log);
+    }
+    return 0;
+}
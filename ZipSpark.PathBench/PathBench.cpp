@@ -0,0 +1,136 @@
+// ZipSpark.PathBench: times PathValidator::Resolve against the per-entry
+// weakly_canonical check it replaced, on synthetic archive entry paths.
+// Usage: ZipSpark.PathBench [count] [destination]
+#include "../Utils/PathValidator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Entry paths shaped like a real archive listing: mostly nested source and
+// asset files, with a few traversal attempts and names Win32 rewrites
+std::vector<std::wstring> MakePaths(size_t count)
+{
+    static const wchar_t* const folders[] = {
+        L"src", L"include", L"assets", L"docs", L"build", L"third_party", L"tests", L"lib", L"bin", L"res"
+    };
+    static const wchar_t* const extensions[] = { L".cpp", L".h", L".png", L".json", L".txt", L".dll" };
+
+    std::mt19937 random(12345);
+    std::vector<std::wstring> paths;
+    paths.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        std::wstring path;
+        size_t depth = 1 + random() % 6;
+        for (size_t level = 0; level < depth; level++)
+        {
+            path += folders[random() % std::size(folders)];
+            path += std::to_wstring(random() % 50);
+            path += (random() % 4 == 0) ? L'\\' : L'/';
+        }
+        path += L"file" + std::to_wstring(i) + extensions[random() % std::size(extensions)];
+
+        switch (random() % 100)
+        {
+        case 0: path = L"../../" + path; break;               // Traversal
+        case 1: path = L"a/../../" + path; break;             // Traversal after a folder
+        case 2: path = L"./" + path; break;                   // Harmless prefix
+        case 3: path += L". "; break;                         // Trailing dot and space
+        case 4: path = L"con/" + path; break;                 // Device name
+        case 5: path.insert(path.size() / 2, L"?"); break;    // Invalid character
+        default: break;
+        }
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
+
+// The check before PathValidator: canonicalize the destination and the joined
+// path for every entry, then compare prefixes
+bool CanonicalCheck(const fs::path& destination, const std::wstring& entryPath)
+{
+    fs::path entry(entryPath);
+    if (entry.is_absolute())
+    {
+        entry = entry.relative_path();
+    }
+
+    std::error_code ec;
+    std::wstring root = fs::weakly_canonical(destination, ec).wstring();
+    if (ec)
+    {
+        return false;
+    }
+    std::wstring full = fs::weakly_canonical(destination / entry, ec).wstring();
+    if (ec)
+    {
+        return false;
+    }
+    return full.size() >= root.size() && full.compare(0, root.size(), root) == 0;
+}
+
+template <typename Check>
+double Measure(const std::vector<std::wstring>& paths, size_t& accepted, Check check)
+{
+    accepted = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::wstring& path : paths)
+    {
+        if (check(path))
+        {
+            accepted++;
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 500000;
+    std::error_code ec;
+    fs::path destination = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path(ec) / "ZipSparkPathBench";
+
+    // Both checks see an existing destination, as during an extraction
+    bool created = fs::create_directories(destination, ec);
+
+    std::vector<std::wstring> paths = MakePaths(count);
+    std::printf("%zu paths, destination %ls\n", paths.size(), destination.wstring().c_str());
+
+    ZipSpark::PathValidator validator(destination);
+    std::wstring relativePath;
+    size_t resolved = 0;
+    double resolveMs = Measure(paths, resolved, [&](const std::wstring& path) {
+        return validator.Resolve(path, relativePath);
+    });
+
+    size_t canonical = 0;
+    double canonicalMs = Measure(paths, canonical, [&](const std::wstring& path) {
+        return CanonicalCheck(destination, path);
+    });
+
+    std::printf("%-20s %10.1f ms %8.1f ns/path %8zu accepted\n", "Resolve", resolveMs,
+                resolveMs * 1e6 / static_cast<double>(paths.size() ? paths.size() : 1), resolved);
+    std::printf("%-20s %10.1f ms %8.1f ns/path %8zu accepted\n", "weakly_canonical", canonicalMs,
+                canonicalMs * 1e6 / static_cast<double>(paths.size() ? paths.size() : 1), canonical);
+    if (resolveMs > 0)
+    {
+        std::printf("Speedup: %.1fx\n", canonicalMs / resolveMs);
+    }
+
+    if (created)
+    {
+        fs::remove(destination, ec);
+    }
+    return 0;
+}